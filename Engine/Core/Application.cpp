@@ -1,6 +1,7 @@
 #include "Application.h"
 #include "Logger.h"
 #include "../Renderer/RendererManager.h"
+#include "JobSystem.h"
 #include <thread>
 #include <chrono>
 #include "Runtime.h"
@@ -48,6 +49,13 @@ void Core::Application::Run() {
 		RendererManager::SelectRenderer(RendererType::DirectX9);
 	}
 	
+	// the editor reads frames back and resizes the window from the main
+	// thread, so only play mode moves rendering onto its own thread
+	RendererManager::UseRenderThread(choice != 1);
+	// the editor shows frames in its own window and never needs the GL one;
+	// OpenGL draws straight into a texture of the editor's when it can
+	RendererManager::SetGLOutput(choice == 1 ? GLOutput::Hosted : GLOutput::Window);
+
 	if (!Renderer::RendererManager::InitRenderer(runtime)) {
 		Logger::Error("No supported renderer could be initialized!");
 		return;
@@ -59,14 +67,14 @@ void Core::Application::Run() {
 	bool running = true;
 
 	while (running) {
+		// finish background loads: geometry swaps and renderer uploads
+		JobSystem::PumpMainThread();
 		runtime->PrepareForFrameRender();
-		Renderer::RendererManager::RenderFrame();
+		running = Renderer::RendererManager::RenderFrame();
 		std::this_thread::sleep_for(std::chrono::milliseconds(16)); // 16 millis so about 62.5 fps ish probably
-
-		// Optional exit logic, for now it runs indefinitely
-		// running = glfwWindowShouldClose(...) || PeekMessage(...) etc.
 	}
 	
 	runtime->Cleanup();
+	JobSystem::Shutdown();
 	Renderer::RendererManager::Shutdown();
 }
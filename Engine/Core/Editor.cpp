@@ -3,6 +3,8 @@
 #include "EditorPanels.h"
 #include "EditorFolderModal.h"
 #include "../Renderer/RendererManager.h"
+#include "../Renderer/RendererGL21.h"
+#include "../Renderer/AsyncMeshLoader.h"
 
 #include <SDL.h>
 #include <cstdlib>
@@ -32,6 +34,53 @@ static bool rightMouseHeld = false;
 
 static SDL_Window   *win      = nullptr;
 static SDL_Renderer *renderer = nullptr;
+// size the GL viewport was last set to
+static int viewWidth  = 0;
+static int viewHeight = 0;
+// the viewport image; kept across frames and only recreated on resize
+static SDL_Texture *viewTexture       = nullptr;
+static int          viewTextureWidth  = 0;
+static int          viewTextureHeight = 0;
+// the GL renderer draws straight into viewTexture, in SDL's own context,
+// instead of having its frames read back and uploaded again
+static bool         hostedView        = false;
+
+static Renderer::RendererGL21* HostedRenderer() {
+	auto* gl = static_cast<Renderer::RendererGL21*>(Renderer::RendererManager::rendererGL);
+	return gl && gl->Output() == Renderer::GLOutput::Hosted ? gl : nullptr;
+}
+
+// Hands the GL renderer a render-target texture of the viewport's size.
+// False when SDL's texture can't be drawn into directly; the renderer is
+// then back on a colour buffer of its own and the view reads frames back.
+static bool CreateHostedView(Renderer::RendererGL21* gl, int width, int height) {
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, width, height);
+	float  scaleX   = 0.0f, scaleY = 0.0f;
+	bool   attached = false;
+	if (texture && SDL_GL_BindTexture(texture, &scaleX, &scaleY) == 0) {
+		// SDL reports texture coordinate scales: 1 for a 2D texture, the
+		// size for a rectangle one, anything else means padded to a power of two
+		bool rectangle = scaleX > 1.0f;
+		if (scaleX == 1.0f || rectangle) {
+			attached = gl->SetHostTargetFromBinding(rectangle, width, height);
+		}
+		SDL_GL_UnbindTexture(texture);
+	}
+	if (!attached) {
+		Logger::Warn("Can't render into the viewport texture; reading frames back instead.");
+		if (texture) SDL_DestroyTexture(texture);
+		gl->SetHostTarget(0, 0, width, height);
+		if (viewTexture) SDL_DestroyTexture(viewTexture);
+		viewTexture = nullptr;
+		return false;
+	}
+	// the old texture goes only once nothing renders into it
+	if (viewTexture) SDL_DestroyTexture(viewTexture);
+	viewTexture       = texture;
+	viewTextureWidth  = width;
+	viewTextureHeight = height;
+	return true;
+}
 nk_context   *ctx      = nullptr;
 
 bool Runtime::EditorRuntime::DeleteMesh(int meshindex) {
@@ -45,10 +94,16 @@ bool Runtime::EditorRuntime::DeleteMesh(int meshindex) {
 }
 
 int Runtime::EditorRuntime::AddMesh(std::string filepath, glm::vec3 pos, glm::vec3 rot) {
-	auto mesh = std::make_shared<Mesh>();
-	if (!mesh->LoadFromOBJ(filepath)) {
-		return -1;
-	}
+	// the mesh shows a placeholder until the load finishes; instances of the
+	// same file share one load and one copy of the geometry
+	auto mesh = AsyncMeshLoader::Load(filepath, MeshLoad_Optimize | MeshLoad_Lods,
+		[this](const std::shared_ptr<Mesh>& loadedMesh, bool loaded) {
+			// the entity may have been deleted while it was loading
+			auto found = std::find(meshes.begin(), meshes.end(), loadedMesh);
+			if (loaded && found != meshes.end()) {
+				Renderer::RendererManager::UpdateMesh(int(found - meshes.begin()), loadedMesh);
+			}
+		});
 	mesh->transform.position = pos;
 	mesh->transform.position = rot;
 
@@ -65,11 +120,15 @@ int Runtime::EditorRuntime::AddMesh(std::string filepath, glm::vec3 pos, glm::ve
 
 // Initialization
 bool Runtime::EditorRuntime::Init() {
-	int gridIndex = AddMesh("assets/models/grid.obj", glm::vec3(0, 0, 0), glm::vec3(0, 0, 0));
-	meshes[gridIndex]->is_castable = false;
-	
-//	int meshIndex2 = AddMesh("assets/models/test2.obj", glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), false);
-//	int meshIndex3 = AddMesh("assets/models/test.obj", glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), false); // we don't feel like adding it now because we're going to push them all in a moment
+	// SDL comes first: a hosted GL renderer has no context to upload
+	// meshes into until SDL has made one
+	Renderer::RendererGL21* gl = HostedRenderer();
+	if (gl) {
+		// the GL renderer draws fixed-function in SDL's context, so SDL
+		// must use OpenGL too, without shader programs of its own bound
+		SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
+		SDL_SetHint(SDL_HINT_RENDER_OPENGL_SHADERS, "0");
+	}
 
 	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
 		Logger::Error(std::string("SDL_Init failed: ") + SDL_GetError());
@@ -80,7 +139,7 @@ bool Runtime::EditorRuntime::Init() {
 		"Nuclear GUI",
 		SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
 		1200, 800,
-		SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+		SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | (gl ? SDL_WINDOW_OPENGL : 0)
 	);
 	if (!win) {
 		Logger::Error(std::string("SDL_CreateWindow failed: ") + SDL_GetError());
@@ -93,6 +152,25 @@ bool Runtime::EditorRuntime::Init() {
 		return false;
 	}
 
+	if (gl) {
+		SDL_RendererInfo info;
+		hostedView = SDL_GetRendererInfo(renderer, &info) == 0 && std::string(info.name) == "opengl"
+			&& (info.flags & SDL_RENDERER_TARGETTEXTURE) && gl->AttachHost(SDL_GL_GetProcAddress);
+		if (!hostedView) {
+			Logger::Warn("Editor can't share SDL's GL context; the viewport will be read back.");
+			if (!gl->CreateOwnContext()) {
+				Logger::Error("OpenGL renderer could not create a context of its own.");
+				return false;
+			}
+		}
+	}
+
+	int gridIndex = AddMesh("assets/models/grid.obj", glm::vec3(0, 0, 0), glm::vec3(0, 0, 0));
+	meshes[gridIndex]->is_castable = false;
+	
+//	int meshIndex2 = AddMesh("assets/models/test2.obj", glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), false);
+//	int meshIndex3 = AddMesh("assets/models/test.obj", glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), false); // we don't feel like adding it now because we're going to push them all in a moment
+
 	ctx = nk_sdl_init(win, renderer);
 	nk_font_atlas *atlas;
 	nk_sdl_font_stash_begin(&atlas);
@@ -254,21 +332,38 @@ void Runtime::EditorRuntime::PrepareForFrameRender() {
 	SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
 	SDL_RenderClear(renderer);
 
-	SDL_Texture* texture = nullptr;  // Declare texture outside the conditional
-
 	if (!EditorFolderModal::ShouldShowFolderOverlay()) {
 		// Normal rendering
 		int top_h = (std::max)(1, drag_y - menu_height);
-		auto frameData = Renderer::RendererManager::rendererGL->CaptureFrame();
-		if (frameData.width != drag_x || frameData.height != top_h) {
+		if (viewWidth != drag_x || viewHeight != top_h) {
 			Renderer::RendererManager::rendererGL->setSize(drag_x, top_h);
-			frameData = Renderer::RendererManager::rendererGL->CaptureFrame();
+			viewWidth  = drag_x;
+			viewHeight = top_h;
 		}
-		SDL_Surface* surface = SDL_CreateRGBSurfaceFrom((void*)frameData.pixels.data(), frameData.width, frameData.height, 32, frameData.width*4,
-													0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
-		texture = SDL_CreateTextureFromSurface(renderer, surface);  // Remove SDL_Texture* here
-		SDL_FreeSurface(surface);
-		struct nk_image nk_img = nk_image_ptr(texture);
+		if (hostedView && (!viewTexture || viewTextureWidth != drag_x || viewTextureHeight != top_h)) {
+			hostedView = CreateHostedView(HostedRenderer(), drag_x, top_h);
+		}
+		// a hosted view's frame is already in viewTexture; read back ones
+		// arrive a frame or two late and may still be the old size
+		static const Renderer::ImageData noFrame;
+		const auto& frameData = hostedView ? noFrame : Renderer::RendererManager::rendererGL->CaptureFrame();
+		if (!frameData.pixels.empty()) {
+			if (!viewTexture || viewTextureWidth != frameData.width || viewTextureHeight != frameData.height) {
+				if (viewTexture) SDL_DestroyTexture(viewTexture);
+				// RGBA32 is the captured byte order, so uploads need no conversion
+				viewTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING,
+												frameData.width, frameData.height);
+				viewTextureWidth  = frameData.width;
+				viewTextureHeight = frameData.height;
+				if (!viewTexture) {
+					Logger::Error(std::string("Could not create the viewport texture: ") + SDL_GetError());
+				}
+			}
+			if (viewTexture) {
+				SDL_UpdateTexture(viewTexture, nullptr, frameData.pixels.data(), frameData.width * 4);
+			}
+		}
+		struct nk_image nk_img = nk_image_ptr(viewTexture);
 
 		// Draw GUI
 		EditorPanels::DrawTopMenu(win_w, menu_height);
@@ -295,11 +390,6 @@ void Runtime::EditorRuntime::PrepareForFrameRender() {
 
 	nk_sdl_render(NK_ANTI_ALIASING_ON);
 	SDL_RenderPresent(renderer);
-
-	// Destroy texture after rendering is complete
-	if (texture) {
-		SDL_DestroyTexture(texture);
-	}
 }
 
 // ProcessInput overloads
@@ -326,6 +416,13 @@ void Runtime::EditorRuntime::ProcessInput(GLFWwindow* window, float dt) {
 // Cleanup
 void Runtime::EditorRuntime::Cleanup() {
 	nk_sdl_shutdown();
+	// our GL objects live in SDL's context, so they go before it does
+	if (Renderer::RendererGL21* gl = HostedRenderer()) {
+		gl->DetachHost();
+	}
+	hostedView = false;
+	if (viewTexture) SDL_DestroyTexture(viewTexture);
+	viewTexture = nullptr;
 	if (renderer) SDL_DestroyRenderer(renderer);
 	if (win) SDL_DestroyWindow(win);
 	SDL_Quit();
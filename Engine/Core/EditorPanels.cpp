@@ -6,6 +6,8 @@
 #include <SDL.h>
 #include <cstdio>
 #include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
 
 extern struct nk_context *ctx;
 extern SDL_Renderer* renderer;
@@ -34,11 +36,42 @@ void DrawTopMenu(int win_w, int menu_height) {
 	nk_end(ctx);
 }
 
+// DebugDraw::Text labels, projected the way the renderers project the
+// scene and drawn over the view image at `view`
+static void DrawDebugTexts(struct nk_rect view) {
+	const auto& texts = Renderer::RendererManager::FrameTexts();
+	const Camera* cam = Renderer::RendererManager::cam;
+	const struct nk_user_font* font = ctx->style.font;
+	if (texts.empty() || !cam || !font || view.w <= 0 || view.h <= 0) {
+		return;
+	}
+	// near and far only decide what gets dropped, not where labels land
+	glm::mat4 proj = glm::perspective(glm::radians(Camera::FieldOfView), view.w / view.h, 0.1f, 100.0f);
+	glm::mat4 view_proj = proj * glm::lookAt(cam->transform.position, cam->lookAtPosition, glm::vec3(0, 1, 0));
+	struct nk_command_buffer* canvas = nk_window_get_canvas(ctx);
+	for (const auto& text : texts) {
+		glm::vec4 clip = view_proj * glm::vec4(text.position, 1.0f);
+		if (clip.w <= 0.0f || std::fabs(clip.x) > clip.w || std::fabs(clip.y) > clip.w) {
+			continue;   // behind the camera or off screen
+		}
+		float x = view.x + (clip.x / clip.w * 0.5f + 0.5f) * view.w;
+		float y = view.y + (0.5f - clip.y / clip.w * 0.5f) * view.h;
+		int   length = (int)text.text.size();
+		float width  = font->width(font->userdata, font->height, text.text.c_str(), length);
+		struct nk_color color = nk_rgba(text.color & 0xff, (text.color >> 8) & 0xff,
+										(text.color >> 16) & 0xff, (text.color >> 24) & 0xff);
+		nk_draw_text(canvas, nk_rect(x, y - font->height, width, font->height),
+					 text.text.c_str(), length, font, nk_rgba(0, 0, 0, 0), color);
+	}
+}
+
 void DrawImageView(struct nk_image img, int drag_x, int menu_height, int top_h) {
 	struct nk_rect img_rect = nk_rect(0, (float)menu_height, (float)drag_x, (float)top_h);
 	if (nk_begin(ctx, "Main Image View", img_rect, NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR)) {
 		nk_layout_row_static(ctx, top_h, drag_x, 1);
+		struct nk_rect view = nk_widget_bounds(ctx);
 		nk_image(ctx, img);
+		DrawDebugTexts(view);
 	}
 	nk_end(ctx);
 }
@@ -505,6 +538,7 @@ void DrawProperties(Runtime::EditorRuntime *editor, int side_x, int sidebar_h, i
 		nk_label(ctx, "Properties", NK_TEXT_CENTERED);
 
 		float posX=0.0f, posY=0.0f, posZ=0.0f;
+		nk_bool isStatic = nk_false;
 		
 		if (0 <= selected_item && selected_item < entityIndexes.size()){
 			int currentmesh = entityIndexes[selected_item];
@@ -515,6 +549,7 @@ void DrawProperties(Runtime::EditorRuntime *editor, int side_x, int sidebar_h, i
 				posX = baseMesh->transform.position.x;
 				posY = baseMesh->transform.position.y;
 				posZ = baseMesh->transform.position.z;
+				isStatic = baseMesh->is_static;
 			}
 		}
 		
@@ -562,6 +597,11 @@ void DrawProperties(Runtime::EditorRuntime *editor, int side_x, int sidebar_h, i
 		float y = draw_field("Position Y", posY, bufY);
 		float z = draw_field("Position Z", posZ, bufZ);
 		
+		// static meshes are merged into the renderer's batches
+		nk_bool wasStatic = isStatic;
+		nk_layout_row_dynamic(ctx, 22, 1);
+		nk_checkbox_label(ctx, "Static", &isStatic);
+		
 		if (0 <= selected_item && selected_item < entityIndexes.size()){
 			int currentmesh = entityIndexes[selected_item];
 			
@@ -592,7 +632,18 @@ void DrawProperties(Runtime::EditorRuntime *editor, int side_x, int sidebar_h, i
 						mesh->transform.position.x += dx;
 						mesh->transform.position.y += dy;
 						mesh->transform.position.z += dz;
-						Renderer::RendererManager::UpdateMesh(thismesh, mesh);
+						Renderer::RendererManager::UpdateTransform(thismesh, mesh->transform);
+					}
+				}
+				
+				if (isStatic != wasStatic) {
+					for (int i = selected_item; i < end_selection; i++) {
+						int thismesh = entityIndexes[i];
+						if (thismesh < 0 || thismesh >= editor->meshes.size() || !editor->meshes[thismesh]) {
+							continue;
+						}
+						editor->meshes[thismesh]->is_static = isStatic;
+						Renderer::RendererManager::UpdateMesh(thismesh, editor->meshes[thismesh]);
 					}
 				}
 			}
@@ -0,0 +1,113 @@
+#include "JobSystem.h"
+#include "Logger.h"
+#include <chrono>
+
+namespace Core {
+	std::vector<std::thread> JobSystem::workers;
+	std::deque<JobSystem::Job> JobSystem::jobs;
+	std::deque<JobSystem::Job> JobSystem::mainJobs;
+	std::mutex               JobSystem::jobMutex;
+	std::mutex               JobSystem::mainMutex;
+	std::condition_variable  JobSystem::jobReady;
+	size_t                   JobSystem::running  = 0;
+	bool                     JobSystem::stopping = false;
+
+	void JobSystem::Init(unsigned threadCount) {
+		std::lock_guard<std::mutex> lock(jobMutex);
+		StartWorkers(threadCount);
+	}
+
+	// jobMutex must be held
+	void JobSystem::StartWorkers(unsigned threadCount) {
+		if (!workers.empty()) {
+			return;
+		}
+		if (threadCount == 0) {
+			unsigned hardware = std::thread::hardware_concurrency();
+			threadCount = hardware > 1 ? hardware - 1 : 1u;
+		}
+		stopping = false;
+		for (unsigned i = 0; i < threadCount; ++i) {
+			workers.emplace_back(WorkerLoop);
+		}
+		Logger::Info("Job system started with " + std::to_string(threadCount) + " workers.");
+	}
+
+	void JobSystem::Shutdown() {
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			stopping = true;
+			jobs.clear();
+		}
+		jobReady.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		workers.clear();
+
+		std::lock_guard<std::mutex> lock(mainMutex);
+		mainJobs.clear();
+	}
+
+	void JobSystem::Submit(Job job) {
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			StartWorkers(0);
+			jobs.push_back(std::move(job));
+		}
+		jobReady.notify_one();
+	}
+
+	void JobSystem::PostToMain(Job job) {
+		std::lock_guard<std::mutex> lock(mainMutex);
+		mainJobs.push_back(std::move(job));
+	}
+
+	size_t JobSystem::PumpMainThread(double budgetMs) {
+		auto start = std::chrono::steady_clock::now();
+		size_t ran = 0;
+		for (;;) {
+			Job job;
+			{
+				std::lock_guard<std::mutex> lock(mainMutex);
+				if (mainJobs.empty()) {
+					break;
+				}
+				job = std::move(mainJobs.front());
+				mainJobs.pop_front();
+			}
+			job();
+			++ran;
+
+			double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (elapsed >= budgetMs) {
+				break;
+			}
+		}
+		return ran;
+	}
+
+	size_t JobSystem::Pending() {
+		std::lock_guard<std::mutex> lock(jobMutex);
+		return jobs.size() + running;
+	}
+
+	void JobSystem::WorkerLoop() {
+		for (;;) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(jobMutex);
+				jobReady.wait(lock, [] { return stopping || !jobs.empty(); });
+				if (stopping) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+				++running;
+			}
+			job();
+			std::lock_guard<std::mutex> lock(jobMutex);
+			--running;
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+namespace Core {
+	// Small worker pool for background work (asset loading, cooking) plus a
+	// queue of completions that must run on the main thread, e.g. anything
+	// that touches the renderer. Workers start on the first Submit.
+	class JobSystem {
+	public:
+		using Job = std::function<void()>;
+
+		// 0 threads = one per core minus the main thread
+		static void Init(unsigned threadCount = 0);
+		// finishes running jobs, drops queued ones and joins the workers
+		static void Shutdown();
+
+		static void Submit(Job job);
+
+		// Queues `job` for the next PumpMainThread call. Safe from any thread.
+		static void PostToMain(Job job);
+
+		// Runs queued main-thread jobs until the queue is empty or `budgetMs`
+		// has passed (at least one job always runs). Returns how many ran.
+		static size_t PumpMainThread(double budgetMs = 2.0);
+
+		// jobs queued or running on the workers
+		static size_t Pending();
+
+	private:
+		static void StartWorkers(unsigned threadCount);
+		static void WorkerLoop();
+
+		static std::vector<std::thread> workers;
+		static std::deque<Job>          jobs;
+		static std::deque<Job>          mainJobs;
+		static std::mutex               jobMutex;
+		static std::mutex               mainMutex;
+		static std::condition_variable  jobReady;
+		static size_t                   running;
+		static bool                     stopping;
+	};
+}
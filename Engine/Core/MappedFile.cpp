@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		std::swap(view, other.view);
+		std::swap(length, other.length);
+		std::swap(open, other.open);
+#ifdef _WIN32
+		std::swap(fileHandle, other.fileHandle);
+		std::swap(mappingHandle, other.mappingHandle);
+#else
+		std::swap(fd, other.fd);
+#endif
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const std::string& path) {
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	length     = static_cast<size_t>(fileSize.QuadPart);
+	open       = true;
+
+	// mapping a zero-length file fails, an empty view is still a valid file
+	if (length == 0) {
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		Close();
+		return false;
+	}
+	mappingHandle = mapping;
+
+	view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!view) {
+		Close();
+		return false;
+	}
+#else
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		Close();
+		return false;
+	}
+
+	length = static_cast<size_t>(st.st_size);
+	open   = true;
+
+	if (length == 0) {
+		return true;
+	}
+
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapped == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	madvise(mapped, length, MADV_SEQUENTIAL);
+	view = static_cast<const char*>(mapped);
+#endif
+
+	return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (view)          UnmapViewOfFile(view);
+	if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+	if (fileHandle)    CloseHandle(static_cast<HANDLE>(fileHandle));
+	mappingHandle = nullptr;
+	fileHandle    = nullptr;
+#else
+	if (view)    munmap(const_cast<char*>(view), length);
+	if (fd >= 0) ::close(fd);
+	fd = -1;
+#endif
+	view   = nullptr;
+	length = 0;
+	open   = false;
+}
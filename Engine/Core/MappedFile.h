@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only view of a whole file mapped into memory.
+// The view stays valid until Close() or the destructor runs.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	bool Open(const std::string& path);
+	void Close();
+
+	const char* Data() const { return view; }
+	size_t      Size() const { return length; }
+	bool        IsOpen() const { return open; }
+
+private:
+	const char* view   = nullptr;
+	size_t      length = 0;
+	bool        open   = false;
+
+#ifdef _WIN32
+	void* fileHandle    = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int   fd            = -1;
+#endif
+};
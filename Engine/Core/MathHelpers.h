@@ -72,19 +72,20 @@ namespace MathHelpers {
 		for (int indx = 0; indx < meish.size(); indx++) {
 			const auto& mesh = meish[indx];
 			
-			if (!mesh->is_castable){
+			if (!mesh->is_castable || !mesh->geometry){
 				continue;
 			}
+			const MeshGeometry& geometry = *mesh->geometry;
 			
 			glm::mat4 inverseTransform = glm::inverse(mesh->transform.ModelMatrix());
 			glm::vec3 localOrigin = glm::vec3(inverseTransform * glm::vec4(ray.origin, 1.0));
 			glm::vec3 localDirection = glm::normalize(glm::vec3(inverseTransform * glm::vec4(ray.direction, 0.0)));
 			Ray localRay{ localOrigin, localDirection };
 			
-			for (size_t i = 0; i < mesh->indices.size(); i += 3) {
-				const glm::vec3& v0 = mesh->vertices[mesh->indices[i]].position;
-				const glm::vec3& v1 = mesh->vertices[mesh->indices[i + 1]].position;
-				const glm::vec3& v2 = mesh->vertices[mesh->indices[i + 2]].position;
+			for (size_t i = 0; i < geometry.indices.size(); i += 3) {
+				glm::vec3 v0 = geometry.Position(geometry.indices[i]);
+				glm::vec3 v1 = geometry.Position(geometry.indices[i + 1]);
+				glm::vec3 v2 = geometry.Position(geometry.indices[i + 2]);
 	
 				if (auto t = RayIntersectsTriangle(localRay, v0, v1, v2)) {
 					if (!closestHit || *t < *closestHit) {
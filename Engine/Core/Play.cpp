@@ -1,24 +1,23 @@
 #include "Play.h"
 #include "../Renderer/RendererManager.h"
+#include "../Renderer/AsyncMeshLoader.h"
 #include "Logger.h"
 
 bool Runtime::PlayRuntime::Init() {
-	// Load meshes
-	auto mesh1 = std::make_shared<Mesh>();
-	if (!mesh1->LoadFromOBJ("assets/models/test2.obj")) {
-		Logger::Error("Failed to load OBJ test2.obj");
-		return false;
+	// Load meshes in the background; each draws as a placeholder box until
+	// its geometry arrives and is handed to the renderer
+	const char* paths[] = { "assets/models/test2.obj", "assets/models/test.obj" };
+	const glm::vec3 positions[] = { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f) };
+	for (int i = 0; i < 2; i++) {
+		auto mesh = AsyncMeshLoader::Load(paths[i], MeshLoad_Optimize | MeshLoad_Lods | MeshLoad_Pack,
+			[i](const std::shared_ptr<Mesh>& mesh, bool loaded) {
+				if (loaded) {
+					Renderer::RendererManager::UpdateMesh(i, mesh);
+				}
+			});
+		mesh->transform.position = positions[i];
+		meshes.push_back(mesh);
 	}
-	mesh1->transform.position = glm::vec3(0.0f, 0.0f, 0.0f);
-	meshes.push_back(mesh1);
-
-	auto mesh2 = std::make_shared<Mesh>();
-	if (!mesh2->LoadFromOBJ("assets/models/test.obj")) {
-		Logger::Error("Failed to load OBJ test.obj");
-		return false;
-	}
-	mesh2->transform.position = glm::vec3(1.0f, 1.0f, 1.0f);
-	meshes.push_back(mesh2);
 	
 	Renderer::RendererManager::SetMeshes(meshes);
 	
@@ -30,7 +29,7 @@ void Runtime::PlayRuntime::PrepareForFrameRender() {
 	
 	meshes[0]->transform.TranslateBy(glm::vec3(0, 0.01, 0));
 	meshes[1]->transform.RotateBy(glm::vec3(0, 0.1, 0.01));
-	Renderer::RendererManager::UpdateMesh(0, meshes[0]);
+	Renderer::RendererManager::UpdateTransform(0, meshes[0]->transform);
 }
 
 void Runtime::PlayRuntime::Cleanup() {
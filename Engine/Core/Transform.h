@@ -44,6 +44,11 @@ struct Transform {
 		// leave roll unchanged
 	}
 
+	bool operator==(const Transform& other) const {
+		return position == other.position && rotation == other.rotation && scale == other.scale;
+	}
+	bool operator!=(const Transform& other) const { return !(*this == other); }
+
 	glm::mat4 ModelMatrix() const {
 		glm::mat4 m = glm::translate(glm::mat4(1.0f), position);
 		m *= RotationMatrix();
@@ -3,8 +3,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-unsigned char* stb_impl::LoadImageFromFile(const char* filename, int* width, int* height, int* channels) {
-	return stbi_load(filename, width, height, channels, 0);
+unsigned char* stb_impl::LoadImageFromFile(const char* filename, int* width, int* height, int* channels, int desiredChannels) {
+	return stbi_load(filename, width, height, channels, desiredChannels);
 }
 
 void stb_impl::FreeImageData(unsigned char* data) {
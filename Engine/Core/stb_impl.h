@@ -2,6 +2,7 @@
 
 class stb_impl {
 public:
-	static unsigned char* LoadImageFromFile(const char* filename, int* width, int* height, int* channels);
+	// `desiredChannels` 0 keeps the file's own channel count
+	static unsigned char* LoadImageFromFile(const char* filename, int* width, int* height, int* channels, int desiredChannels = 0);
 	static void FreeImageData(unsigned char* data);
 };
\ No newline at end of file
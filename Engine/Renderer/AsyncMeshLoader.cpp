@@ -0,0 +1,59 @@
+#include "AsyncMeshLoader.h"
+#include "GeometryCache.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Logger.h"
+
+namespace {
+	std::shared_ptr<const MeshGeometry> MakeBox() {
+		std::vector<Vertex>   verts;
+		std::vector<uint32_t> inds;
+		for (int axis = 0; axis < 3; ++axis) {
+			for (int side = -1; side <= 1; side += 2) {
+				glm::vec3 n(0.0f);
+				n[axis] = float(side);
+				glm::vec3 u(0.0f), v(0.0f);
+				u[(axis + 1) % 3] = 0.5f;
+				v[(axis + 2) % 3] = 0.5f * side;   // keeps the winding outward on both sides
+
+				uint32_t base = static_cast<uint32_t>(verts.size());
+				const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+				for (const auto& c : corners) {
+					Vertex vert{};
+					vert.position = n * 0.5f + u * c[0] + v * c[1];
+					vert.normal   = n;
+					vert.texcoord = glm::vec2((c[0] + 1) * 0.5f, (c[1] + 1) * 0.5f);
+					verts.push_back(vert);
+				}
+				inds.insert(inds.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+			}
+		}
+		return std::make_shared<MeshGeometry>(std::move(verts), std::move(inds));
+	}
+}
+
+std::shared_ptr<const MeshGeometry> AsyncMeshLoader::Placeholder() {
+	static const std::shared_ptr<const MeshGeometry> box = MakeBox();
+	return box;
+}
+
+std::shared_ptr<Mesh> AsyncMeshLoader::Load(const std::string& path, uint32_t flags, ReadyCallback onReady) {
+	auto mesh = std::make_shared<Mesh>(Placeholder());
+
+	Core::JobSystem::Submit([mesh, path, flags, onReady]() {
+		std::shared_ptr<const MeshGeometry> geometry = GeometryCache::Load(path, flags);
+		if (!geometry) {
+			Logger::Error("Async load failed: " + path);
+		}
+
+		Core::JobSystem::PostToMain([mesh, geometry, onReady]() {
+			if (geometry) {
+				mesh->geometry = geometry;
+			}
+			if (onReady) {
+				onReady(mesh, geometry != nullptr);
+			}
+		});
+	});
+
+	return mesh;
+}
@@ -0,0 +1,27 @@
+// AsyncMeshLoader.h
+#pragma once
+
+#include "Mesh.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Loads mesh geometry on the job system without blocking the caller. The
+// returned Mesh draws a placeholder until its geometry arrives; the swap and
+// `onReady` both run on the main thread from Core::JobSystem::PumpMainThread,
+// so that is where renderer updates (RendererManager::UpdateMesh) belong.
+class AsyncMeshLoader {
+public:
+	using ReadyCallback = std::function<void(const std::shared_ptr<Mesh>& mesh, bool loaded)>;
+
+	// Loads through GeometryCache, so repeated paths share one load.
+	// `loaded` is false if the file could not be read; the placeholder stays.
+	static std::shared_ptr<Mesh> Load(const std::string& path, uint32_t flags = MeshLoad_Default,
+									  ReadyCallback onReady = nullptr);
+
+	// Unit box centred on the origin, shared by every pending mesh.
+	static std::shared_ptr<const MeshGeometry> Placeholder();
+
+	static bool IsPlaceholder(const Mesh& mesh) { return mesh.geometry == Placeholder(); }
+};
@@ -0,0 +1,283 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace BlockCompression {
+	namespace {
+		struct Color {
+			float r, g, b;
+		};
+
+		uint16_t To565(const Color& c) {
+			int r = std::min(31, std::max(0, int(std::lround(c.r * 31.0f / 255.0f))));
+			int g = std::min(63, std::max(0, int(std::lround(c.g * 63.0f / 255.0f))));
+			int b = std::min(31, std::max(0, int(std::lround(c.b * 31.0f / 255.0f))));
+			return uint16_t((r << 11) | (g << 5) | b);
+		}
+
+		// the same expansion the hardware does: replicate the top bits
+		void From565(uint16_t c, int out[3]) {
+			int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+			out[0] = (r << 3) | (r >> 2);
+			out[1] = (g << 2) | (g >> 4);
+			out[2] = (b << 3) | (b >> 2);
+		}
+
+		// c0 > c1 selects the four-colour mode, the only one the encoder emits
+		void Palette(uint16_t c0, uint16_t c1, bool fourColor, int palette[4][3]) {
+			From565(c0, palette[0]);
+			From565(c1, palette[1]);
+			for (int k = 0; k < 3; ++k) {
+				if (fourColor) {
+					palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+					palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+				} else {
+					palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+					palette[3][k] = 0;
+				}
+			}
+		}
+
+		// nearest palette entry per texel; returns the summed squared error
+		int PickIndices(const uint8_t rgba[64], const int palette[4][3], uint8_t indices[16]) {
+			int total = 0;
+			for (int i = 0; i < BlockTexels; ++i) {
+				int best = 0, bestError = 1 << 30;
+				for (int p = 0; p < 4; ++p) {
+					int dr = rgba[i * 4 + 0] - palette[p][0];
+					int dg = rgba[i * 4 + 1] - palette[p][1];
+					int db = rgba[i * 4 + 2] - palette[p][2];
+					int error = dr * dr + dg * dg + db * db;
+					if (error < bestError) {
+						bestError = error;
+						best = p;
+					}
+				}
+				indices[i] = uint8_t(best);
+				total += bestError;
+			}
+			return total;
+		}
+
+		// Endpoints that best reproduce the texels for fixed indices: each
+		// texel is a*c0 + b*c1, solved for c0 and c1 by least squares.
+		bool FitEndpoints(const uint8_t rgba[64], const uint8_t indices[16], Color& c0, Color& c1) {
+			static const float weight0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+			float aa = 0, ab = 0, bb = 0;
+			Color ax = {0, 0, 0}, bx = {0, 0, 0};
+			for (int i = 0; i < BlockTexels; ++i) {
+				float a = weight0[indices[i]], b = 1.0f - a;
+				aa += a * a;
+				ab += a * b;
+				bb += b * b;
+				ax.r += a * rgba[i * 4 + 0]; ax.g += a * rgba[i * 4 + 1]; ax.b += a * rgba[i * 4 + 2];
+				bx.r += b * rgba[i * 4 + 0]; bx.g += b * rgba[i * 4 + 1]; bx.b += b * rgba[i * 4 + 2];
+			}
+			float det = aa * bb - ab * ab;
+			if (std::fabs(det) < 1e-6f) {
+				return false;
+			}
+			float inv = 1.0f / det;
+			c0 = { (ax.r * bb - bx.r * ab) * inv, (ax.g * bb - bx.g * ab) * inv, (ax.b * bb - bx.b * ab) * inv };
+			c1 = { (bx.r * aa - ax.r * ab) * inv, (bx.g * aa - ax.g * ab) * inv, (bx.b * aa - ax.b * ab) * inv };
+			return true;
+		}
+
+		void WriteColorBlock(uint16_t c0, uint16_t c1, const uint8_t indices[16], uint8_t out[8]) {
+			uint32_t bits = 0;
+			for (int i = 0; i < BlockTexels; ++i) {
+				bits |= uint32_t(indices[i]) << (i * 2);
+			}
+			out[0] = uint8_t(c0); out[1] = uint8_t(c0 >> 8);
+			out[2] = uint8_t(c1); out[3] = uint8_t(c1 >> 8);
+			memcpy(out + 4, &bits, 4);
+		}
+
+		void EncodeColorBlock(const uint8_t rgba[64], uint8_t out[8]) {
+			Color mean = {0, 0, 0};
+			for (int i = 0; i < BlockTexels; ++i) {
+				mean.r += rgba[i * 4 + 0];
+				mean.g += rgba[i * 4 + 1];
+				mean.b += rgba[i * 4 + 2];
+			}
+			mean = { mean.r / BlockTexels, mean.g / BlockTexels, mean.b / BlockTexels };
+
+			// principal axis of the colours by power iteration on their covariance
+			float cov[6] = {};   // rr rg rb gg gb bb
+			for (int i = 0; i < BlockTexels; ++i) {
+				float r = rgba[i * 4 + 0] - mean.r, g = rgba[i * 4 + 1] - mean.g, b = rgba[i * 4 + 2] - mean.b;
+				cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+				cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+			}
+			Color axis = {1.0f, 1.0f, 1.0f};
+			for (int iteration = 0; iteration < 8; ++iteration) {
+				Color next = {
+					cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+					cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+					cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b,
+				};
+				float length = std::max(std::fabs(next.r), std::max(std::fabs(next.g), std::fabs(next.b)));
+				if (length < 1e-6f) {
+					break;   // a flat block, any axis does
+				}
+				axis = { next.r / length, next.g / length, next.b / length };
+			}
+
+			float lo = 0.0f, hi = 0.0f;
+			for (int i = 0; i < BlockTexels; ++i) {
+				float t = (rgba[i * 4 + 0] - mean.r) * axis.r + (rgba[i * 4 + 1] - mean.g) * axis.g + (rgba[i * 4 + 2] - mean.b) * axis.b;
+				lo = std::min(lo, t);
+				hi = std::max(hi, t);
+			}
+			float axisLength2 = axis.r * axis.r + axis.g * axis.g + axis.b * axis.b;
+			if (axisLength2 > 0.0f) {
+				lo /= axisLength2;
+				hi /= axisLength2;
+			}
+			Color e0 = { mean.r + axis.r * hi, mean.g + axis.g * hi, mean.b + axis.b * hi };
+			Color e1 = { mean.r + axis.r * lo, mean.g + axis.g * lo, mean.b + axis.b * lo };
+
+			// a few rounds of quantize, pick indices, refit; keep the best
+			uint16_t bestC0 = 0, bestC1 = 0;
+			uint8_t  bestIndices[16] = {};
+			int      bestError = -1;
+			for (int round = 0; round < 3; ++round) {
+				uint16_t c0 = To565(e0), c1 = To565(e1);
+				if (c0 < c1) {
+					std::swap(c0, c1);
+				}
+				int palette[4][3];
+				Palette(c0, c1, true, palette);
+				if (c0 == c1) {
+					// reads as three-colour mode, where only index 0 is safe;
+					// with every entry the same, PickIndices never leaves it
+					for (int p = 1; p < 4; ++p) {
+						memcpy(palette[p], palette[0], sizeof(palette[0]));
+					}
+				}
+				uint8_t indices[16];
+				int error = PickIndices(rgba, palette, indices);
+				if (bestError < 0 || error < bestError) {
+					bestError = error;
+					bestC0 = c0;
+					bestC1 = c1;
+					memcpy(bestIndices, indices, sizeof(indices));
+				}
+				if (error == 0 || c0 == c1 || !FitEndpoints(rgba, indices, e0, e1)) {
+					break;
+				}
+			}
+			WriteColorBlock(bestC0, bestC1, bestIndices, out);
+		}
+
+		void DecodeColorBlock(const uint8_t block[8], bool alwaysFourColor, uint8_t rgba[64]) {
+			uint16_t c0 = uint16_t(block[0] | (block[1] << 8));
+			uint16_t c1 = uint16_t(block[2] | (block[3] << 8));
+			bool fourColor = alwaysFourColor || c0 > c1;
+			int palette[4][3];
+			Palette(c0, c1, fourColor, palette);
+			uint32_t bits;
+			memcpy(&bits, block + 4, 4);
+			for (int i = 0; i < BlockTexels; ++i) {
+				int index = (bits >> (i * 2)) & 3;
+				rgba[i * 4 + 0] = uint8_t(palette[index][0]);
+				rgba[i * 4 + 1] = uint8_t(palette[index][1]);
+				rgba[i * 4 + 2] = uint8_t(palette[index][2]);
+				rgba[i * 4 + 3] = (!fourColor && index == 3) ? 0 : 255;
+			}
+		}
+
+		// a0 > a1: a0, a1 and six steps between them
+		void AlphaPalette(int a0, int a1, int palette[8]) {
+			palette[0] = a0;
+			palette[1] = a1;
+			if (a0 > a1) {
+				for (int i = 1; i < 7; ++i) {
+					palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+				}
+			} else {
+				for (int i = 1; i < 5; ++i) {
+					palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+				}
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+	}
+
+	void EncodeBC1(const uint8_t rgba[64], uint8_t out[8]) {
+		EncodeColorBlock(rgba, out);
+	}
+
+	void EncodeBC3(const uint8_t rgba[64], uint8_t out[16]) {
+		EncodeBC4(rgba, 3, out);
+		EncodeColorBlock(rgba, out + 8);
+	}
+
+	void EncodeBC5(const uint8_t rgba[64], uint8_t out[16]) {
+		EncodeBC4(rgba, 0, out);
+		EncodeBC4(rgba, 1, out + 8);
+	}
+
+	void EncodeBC4(const uint8_t rgba[64], int channel, uint8_t out[8]) {
+		int lo = 255, hi = 0;
+		for (int i = 0; i < BlockTexels; ++i) {
+			lo = std::min(lo, int(rgba[i * 4 + channel]));
+			hi = std::max(hi, int(rgba[i * 4 + channel]));
+		}
+		uint64_t bits = 0;
+		if (hi > lo) {
+			int palette[8];
+			AlphaPalette(hi, lo, palette);
+			for (int i = 0; i < BlockTexels; ++i) {
+				int value = rgba[i * 4 + channel];
+				int best = 0, bestError = 256;
+				for (int p = 0; p < 8; ++p) {
+					int error = std::abs(value - palette[p]);
+					if (error < bestError) {
+						bestError = error;
+						best = p;
+					}
+				}
+				bits |= uint64_t(best) << (i * 3);
+			}
+		}
+		// a flat block leaves every index 0, which is a0 in either mode
+		out[0] = uint8_t(hi);
+		out[1] = uint8_t(hi > lo ? lo : hi);
+		for (int b = 0; b < 6; ++b) {
+			out[2 + b] = uint8_t(bits >> (b * 8));
+		}
+	}
+
+	void DecodeBC1(const uint8_t block[8], uint8_t rgba[64]) {
+		DecodeColorBlock(block, false, rgba);
+	}
+
+	void DecodeBC3(const uint8_t block[16], uint8_t rgba[64]) {
+		DecodeColorBlock(block + 8, true, rgba);
+		DecodeBC4(block, 3, rgba);
+	}
+
+	void DecodeBC5(const uint8_t block[16], uint8_t rgba[64]) {
+		DecodeBC4(block, 0, rgba);
+		DecodeBC4(block + 8, 1, rgba);
+		for (int i = 0; i < BlockTexels; ++i) {
+			rgba[i * 4 + 2] = 0;
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+	void DecodeBC4(const uint8_t block[8], int channel, uint8_t rgba[64]) {
+		int palette[8];
+		AlphaPalette(block[0], block[1], palette);
+		uint64_t bits = 0;
+		for (int b = 0; b < 6; ++b) {
+			bits |= uint64_t(block[2 + b]) << (b * 8);
+		}
+		for (int i = 0; i < BlockTexels; ++i) {
+			rgba[i * 4 + channel] = uint8_t(palette[(bits >> (i * 3)) & 7]);
+		}
+	}
+}
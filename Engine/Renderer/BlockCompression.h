@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+// CPU encoders and decoders for single BC blocks. Every function takes or
+// fills one 4x4 block of RGBA8 texels, rows top to bottom (64 bytes).
+// Encoding is meant for the offline cooker, decoding for renderers that
+// can't sample a format and for checking the encoder.
+namespace BlockCompression {
+	constexpr int BlockTexels = 16;
+
+	// BC1: endpoints along the colours' principal axis, refined by a least
+	// squares fit to the chosen indices. Alpha is ignored (always opaque).
+	void EncodeBC1(const uint8_t rgba[64], uint8_t out[8]);
+	// BC3: a BC1 colour block behind a BC4 block for alpha.
+	void EncodeBC3(const uint8_t rgba[64], uint8_t out[16]);
+	// BC5: red and green as two BC4 blocks; blue and alpha are dropped.
+	void EncodeBC5(const uint8_t rgba[64], uint8_t out[16]);
+	// BC4: one channel (`channel` 0..3 of each texel) in the 8-value mode.
+	void EncodeBC4(const uint8_t rgba[64], int channel, uint8_t out[8]);
+
+	void DecodeBC1(const uint8_t block[8], uint8_t rgba[64]);
+	void DecodeBC3(const uint8_t block[16], uint8_t rgba[64]);
+	// blue comes back 0 and alpha 255
+	void DecodeBC5(const uint8_t block[16], uint8_t rgba[64]);
+	// writes only `channel` of each texel
+	void DecodeBC4(const uint8_t block[8], int channel, uint8_t rgba[64]);
+}
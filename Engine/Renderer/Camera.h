@@ -13,6 +13,9 @@ public:
 	Transform transform;
 	glm::vec3 lookAtPosition;  // computed each frame (transform.position + forward)
 
+	// Vertical field of view in degrees; both renderers project with it
+	static constexpr float FieldOfView = 60.0f;
+
 	// Tuning parameters
 	float movementSpeed    = 5.0f;   // units per second
 	float mouseSensitivity = 0.1f;   // degrees per pixel
@@ -0,0 +1,186 @@
+#include "DebugDraw.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Renderer {
+	namespace {
+		const int CircleSegments = 16;
+
+		// cos/sin around the unit circle, computed once instead of per primitive
+		struct CircleTable {
+			float cos[CircleSegments + 1];
+			float sin[CircleSegments + 1];
+			CircleTable() {
+				for (int i = 0; i <= CircleSegments; ++i) {
+					float a = 2.0f * 3.14159265358979f * float(i) / CircleSegments;
+					cos[i] = std::cos(a);
+					sin[i] = std::sin(a);
+				}
+			}
+		};
+		const CircleTable circle;
+
+		DebugDrawList::Bucket BucketFor(bool depthTest) {
+			return depthTest ? DebugDrawList::Depth : DebugDrawList::Overlay;
+		}
+
+		uint32_t ToByte(float value) {
+			return uint32_t(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+	}
+
+	uint32_t DebugDrawList::Color(float r, float g, float b, float a) {
+		return ToByte(r) | (ToByte(g) << 8) | (ToByte(b) << 16) | (ToByte(a) << 24);
+	}
+
+	void DebugDrawList::Line(const glm::vec3& from, const glm::vec3& to, uint32_t color, bool depthTest) {
+		std::vector<DebugVertex>& out = lines[BucketFor(depthTest)];
+		out.push_back({from, color});
+		out.push_back({to, color});
+	}
+
+	void DebugDrawList::Arrow(const glm::vec3& from, const glm::vec3& to, uint32_t color,
+							  float shaftRadius, float headLength, bool depthTest) {
+		glm::vec3 dir    = to - from;
+		float     length = glm::length(dir);
+		if (length < 1e-6f) {
+			return;
+		}
+		// any two axes perpendicular to the arrow will do
+		glm::vec3 w = dir / length;
+		glm::vec3 u = glm::normalize(glm::cross(w, std::abs(w.y) < 0.99f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0)));
+		glm::vec3 v = glm::cross(w, u);
+
+		headLength        = std::min(headLength, length);
+		float headRadius  = shaftRadius * 3.0f;
+		glm::vec3 neck    = from + w * (length - headLength);
+
+		std::vector<DebugVertex>& out = triangles[BucketFor(depthTest)];
+		out.reserve(out.size() + CircleSegments * 9);
+		for (int i = 0; i < CircleSegments; ++i) {
+			glm::vec3 r0 = u * circle.cos[i]     + v * circle.sin[i];
+			glm::vec3 r1 = u * circle.cos[i + 1] + v * circle.sin[i + 1];
+			// shaft side, two triangles
+			glm::vec3 a0 = from + r0 * shaftRadius, a1 = from + r1 * shaftRadius;
+			glm::vec3 b0 = neck + r0 * shaftRadius, b1 = neck + r1 * shaftRadius;
+			out.push_back({a0, color}); out.push_back({b0, color}); out.push_back({b1, color});
+			out.push_back({a0, color}); out.push_back({b1, color}); out.push_back({a1, color});
+			// head, one triangle to the tip
+			out.push_back({neck + r0 * headRadius, color});
+			out.push_back({neck + r1 * headRadius, color});
+			out.push_back({to, color});
+		}
+	}
+
+	void DebugDrawList::Box(const glm::vec3& min, const glm::vec3& max, uint32_t color, bool depthTest) {
+		glm::vec3 c[8];
+		for (int i = 0; i < 8; ++i) {
+			c[i] = glm::vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+		}
+		// corners differing in one bit share an edge
+		static const int edges[12][2] = {
+			{0, 1}, {2, 3}, {4, 5}, {6, 7},
+			{0, 2}, {1, 3}, {4, 6}, {5, 7},
+			{0, 4}, {1, 5}, {2, 6}, {3, 7},
+		};
+		std::vector<DebugVertex>& out = lines[BucketFor(depthTest)];
+		for (const auto& edge : edges) {
+			out.push_back({c[edge[0]], color});
+			out.push_back({c[edge[1]], color});
+		}
+	}
+
+	void DebugDrawList::Sphere(const glm::vec3& center, float radius, uint32_t color, bool depthTest) {
+		Bucket bucket = BucketFor(depthTest);
+		Circle(center, glm::vec3(radius, 0, 0), glm::vec3(0, radius, 0), color, bucket);
+		Circle(center, glm::vec3(0, radius, 0), glm::vec3(0, 0, radius), color, bucket);
+		Circle(center, glm::vec3(0, 0, radius), glm::vec3(radius, 0, 0), color, bucket);
+	}
+
+	void DebugDrawList::Circle(const glm::vec3& center, const glm::vec3& u, const glm::vec3& v, uint32_t color, Bucket bucket) {
+		std::vector<DebugVertex>& out = lines[bucket];
+		for (int i = 0; i < CircleSegments; ++i) {
+			out.push_back({center + u * circle.cos[i]     + v * circle.sin[i],     color});
+			out.push_back({center + u * circle.cos[i + 1] + v * circle.sin[i + 1], color});
+		}
+	}
+
+	void DebugDrawList::Text(const glm::vec3& position, const std::string& text, uint32_t color) {
+		texts.push_back({position, color, text});
+	}
+
+	void DebugDrawList::Append(const DebugDrawList& other) {
+		for (int b = 0; b < BucketCount; ++b) {
+			lines[b].insert(lines[b].end(), other.lines[b].begin(), other.lines[b].end());
+			triangles[b].insert(triangles[b].end(), other.triangles[b].begin(), other.triangles[b].end());
+		}
+		texts.insert(texts.end(), other.texts.begin(), other.texts.end());
+	}
+
+	// keeps the storage; the next frame usually needs about as much
+	void DebugDrawList::Clear() {
+		for (int b = 0; b < BucketCount; ++b) {
+			lines[b].clear();
+			triangles[b].clear();
+		}
+		texts.clear();
+	}
+
+	void DebugDrawList::Swap(DebugDrawList& other) {
+		for (int b = 0; b < BucketCount; ++b) {
+			lines[b].swap(other.lines[b]);
+			triangles[b].swap(other.triangles[b]);
+		}
+		texts.swap(other.texts);
+	}
+
+	bool DebugDrawList::Empty() const {
+		return VertexCount() == 0 && texts.empty();
+	}
+
+	size_t DebugDrawList::VertexCount() const {
+		size_t count = 0;
+		for (int b = 0; b < BucketCount; ++b) {
+			count += lines[b].size() + triangles[b].size();
+		}
+		return count;
+	}
+
+#if GW_DEBUG_DRAW
+	std::mutex    DebugDraw::mutex;
+	DebugDrawList DebugDraw::pending;
+
+	void DebugDraw::Line(const glm::vec3& from, const glm::vec3& to, uint32_t color, bool depthTest) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.Line(from, to, color, depthTest);
+	}
+
+	void DebugDraw::Arrow(const glm::vec3& from, const glm::vec3& to, uint32_t color,
+						  float shaftRadius, float headLength, bool depthTest) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.Arrow(from, to, color, shaftRadius, headLength, depthTest);
+	}
+
+	void DebugDraw::Box(const glm::vec3& min, const glm::vec3& max, uint32_t color, bool depthTest) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.Box(min, max, color, depthTest);
+	}
+
+	void DebugDraw::Sphere(const glm::vec3& center, float radius, uint32_t color, bool depthTest) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.Sphere(center, radius, color, depthTest);
+	}
+
+	void DebugDraw::Text(const glm::vec3& position, const std::string& text, uint32_t color) {
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.Text(position, text, color);
+	}
+
+	// `out`'s old storage becomes the next frame's pending list
+	void DebugDraw::Flush(DebugDrawList& out) {
+		out.Clear();
+		std::lock_guard<std::mutex> lock(mutex);
+		out.Swap(pending);
+	}
+#endif
+}
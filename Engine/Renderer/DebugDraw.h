@@ -0,0 +1,107 @@
+// DebugDraw.h
+#pragma once
+
+#include <glm/glm.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// DebugDraw calls compile to nothing unless this is 1; by default it
+// follows the build type. DebugDrawList itself is always there, the
+// editor's gizmos are drawn through one.
+#ifndef GW_DEBUG_DRAW
+	#ifdef NDEBUG
+		#define GW_DEBUG_DRAW 0
+	#else
+		#define GW_DEBUG_DRAW 1
+	#endif
+#endif
+
+namespace Renderer {
+
+// RGBA8, red in the lowest byte: the byte order GL reads as GL_UNSIGNED_BYTE.
+struct DebugVertex {
+	glm::vec3 position;
+	uint32_t  color;
+};
+static_assert(sizeof(DebugVertex) == 16, "DebugVertex is uploaded as-is");
+
+// A label to show at a world position; the renderers leave text to the UI.
+struct DebugText {
+	glm::vec3   position;
+	uint32_t    color;
+	std::string text;
+};
+
+// One frame's debug primitives, already expanded into plain line and
+// triangle vertices. Everything lands in one of two buckets, depth-tested
+// or drawn on top, so a renderer draws the whole list from one vertex
+// upload with at most a line and a triangle draw per bucket.
+class DebugDrawList {
+public:
+	enum Bucket { Depth = 0, Overlay = 1, BucketCount };
+
+	static uint32_t Color(float r, float g, float b, float a = 1.0f);
+
+	void Line(const glm::vec3& from, const glm::vec3& to, uint32_t color, bool depthTest = true);
+	// Solid shaft and cone from `from` to `to`; the head takes `headLength`
+	// of it and is three times as wide as the shaft.
+	void Arrow(const glm::vec3& from, const glm::vec3& to, uint32_t color,
+			   float shaftRadius, float headLength, bool depthTest = true);
+	// Wireframe axis-aligned box.
+	void Box(const glm::vec3& min, const glm::vec3& max, uint32_t color, bool depthTest = true);
+	// Wireframe sphere: one circle around each axis.
+	void Sphere(const glm::vec3& center, float radius, uint32_t color, bool depthTest = true);
+	void Text(const glm::vec3& position, const std::string& text, uint32_t color);
+
+	void Append(const DebugDrawList& other);
+	void Clear();
+	void Swap(DebugDrawList& other);
+
+	bool   Empty() const;
+	size_t VertexCount() const;
+	const std::vector<DebugVertex>& Lines(Bucket bucket) const     { return lines[bucket]; }
+	const std::vector<DebugVertex>& Triangles(Bucket bucket) const { return triangles[bucket]; }
+	const std::vector<DebugText>&   Texts() const                  { return texts; }
+
+private:
+	void Circle(const glm::vec3& center, const glm::vec3& u, const glm::vec3& v, uint32_t color, Bucket bucket);
+
+	std::vector<DebugVertex> lines[BucketCount];
+	std::vector<DebugVertex> triangles[BucketCount];
+	std::vector<DebugText>   texts;
+};
+
+// Debug drawing for gameplay and editor code. Calls may come from any
+// thread at any point of the frame; RendererManager hands everything
+// recorded since the last frame to the renderer, which draws it once.
+// With GW_DEBUG_DRAW off every call is an empty inline.
+class DebugDraw {
+public:
+#if GW_DEBUG_DRAW
+	static void Line(const glm::vec3& from, const glm::vec3& to, uint32_t color, bool depthTest = true);
+	static void Arrow(const glm::vec3& from, const glm::vec3& to, uint32_t color,
+					  float shaftRadius = 0.02f, float headLength = 0.2f, bool depthTest = true);
+	static void Box(const glm::vec3& min, const glm::vec3& max, uint32_t color, bool depthTest = true);
+	static void Sphere(const glm::vec3& center, float radius, uint32_t color, bool depthTest = true);
+	static void Text(const glm::vec3& position, const std::string& text, uint32_t color);
+
+	// Moves everything recorded so far into `out`, replacing its contents.
+	static void Flush(DebugDrawList& out);
+
+private:
+	static std::mutex    mutex;
+	static DebugDrawList pending;
+#else
+	static void Line(const glm::vec3&, const glm::vec3&, uint32_t, bool = true) {}
+	static void Arrow(const glm::vec3&, const glm::vec3&, uint32_t, float = 0.02f, float = 0.2f, bool = true) {}
+	static void Box(const glm::vec3&, const glm::vec3&, uint32_t, bool = true) {}
+	static void Sphere(const glm::vec3&, float, uint32_t, bool = true) {}
+	static void Text(const glm::vec3&, const std::string&, uint32_t) {}
+	static void Flush(DebugDrawList& out) { out.Clear(); }
+#endif
+};
+
+}
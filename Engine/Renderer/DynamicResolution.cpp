@@ -0,0 +1,71 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Renderer;
+
+namespace {
+	const float Smoothing      = 0.25f;   // weight of the newest frame
+	const float Headroom       = 0.85f;   // only grow below this share of the target
+	const float MaxStepDown    = 0.25f;
+	const float MaxStepUp      = 0.05f;
+	const float MinChange      = 0.02f;   // smaller steps aren't worth a different size
+	const int   CooldownFrames = 3;
+	const float LowestScale    = 0.1f;
+	const float HighestScale   = 2.0f;
+}
+
+float DynamicResolution::Update(const DynamicResolutionSettings& settings, float frameMs) {
+	float lo = std::min(std::max(settings.minScale, LowestScale), HighestScale);
+	float hi = std::min(std::max(settings.maxScale, lo), HighestScale);
+	float target = std::max(settings.targetMs, 0.1f);
+	frameMs = std::max(frameMs, 0.0f);
+
+	smoothedMs = count == 0 ? frameMs : smoothedMs + Smoothing * (frameMs - smoothedMs);
+
+	Sample& sample = history[next];
+	sample.frameMs    = frameMs;
+	sample.smoothedMs = smoothedMs;
+	sample.scale      = scale;
+	next  = (next + 1) % HistorySize;
+	count = std::min(count + 1, HistorySize);
+
+	float wanted = scale;
+	if (cooldown > 0) {
+		cooldown--;
+	} else if (smoothedMs > target) {
+		wanted = std::max(scale * std::sqrt(target / smoothedMs), scale - MaxStepDown);
+	} else if (smoothedMs < target * Headroom) {
+		float ratio = smoothedMs > 0.0f ? target / smoothedMs : 4.0f;
+		wanted = std::min(scale * std::sqrt(ratio), scale + MaxStepUp);
+	}
+	// the bounds apply at once, even mid-cooldown
+	wanted = std::min(std::max(wanted, lo), hi);
+
+	bool bound = wanted == lo || wanted == hi;
+	if (wanted != scale && (bound || std::fabs(wanted - scale) >= MinChange)) {
+		// expect the cost to follow the pixel count until real timings say otherwise
+		float ratio = wanted / scale;
+		smoothedMs *= ratio * ratio;
+		scale    = wanted;
+		cooldown = CooldownFrames;
+	}
+	return scale;
+}
+
+void DynamicResolution::Reset() {
+	scale      = 1.0f;
+	smoothedMs = 0.0f;
+	cooldown   = 0;
+	next  = 0;
+	count = 0;
+}
+
+void DynamicResolution::CopyHistory(std::vector<Sample>& out) const {
+	out.clear();
+	out.reserve(count);
+	size_t first = (next + HistorySize - count) % HistorySize;
+	for (size_t i = 0; i < count; ++i) {
+		out.push_back(history[(first + i) % HistorySize]);
+	}
+}
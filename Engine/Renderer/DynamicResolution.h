@@ -0,0 +1,55 @@
+// DynamicResolution.h
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace Renderer {
+
+// What the scene's render scale is allowed to do. Scales are per axis and
+// relative to the output size, so 0.5 draws a quarter of the pixels.
+struct DynamicResolutionSettings {
+	bool  enabled  = false;
+	float targetMs = 14.0f;   // scene GPU time to hold, a little under a 60 Hz frame
+	float minScale = 0.5f;
+	float maxScale = 1.0f;    // up to 2, which supersamples
+};
+
+// Picks the scene's render scale from measured frame times. Pixel cost
+// goes with the square of the scale, so the step towards the target is
+// the square root of how far off it is. Over budget it drops at once;
+// under budget it only creeps back up once there is clear headroom, and
+// after each change it waits a few frames for the timings to catch up
+// (GPU timings arrive a frame or two late), so it settles instead of
+// hunting. Nothing here touches a graphics API.
+class DynamicResolution {
+public:
+	static const size_t HistorySize = 128;
+
+	struct Sample {
+		float frameMs    = 0.0f;   // as measured
+		float smoothedMs = 0.0f;   // what the controller steered by
+		float scale      = 1.0f;   // in effect when it was measured
+	};
+
+	// Feeds one frame's time, drawn at Scale(); returns the scale for the
+	// next frame.
+	float Update(const DynamicResolutionSettings& settings, float frameMs);
+	// Back to full scale with no history, e.g. when switched off.
+	void  Reset();
+
+	float Scale() const      { return scale; }
+	float SmoothedMs() const { return smoothedMs; }
+	// The last HistorySize samples (fewer until then), oldest first.
+	void  CopyHistory(std::vector<Sample>& out) const;
+
+private:
+	float  scale      = 1.0f;
+	float  smoothedMs = 0.0f;
+	int    cooldown   = 0;
+	Sample history[HistorySize];
+	size_t next  = 0;
+	size_t count = 0;
+};
+
+}
@@ -0,0 +1,194 @@
+#include "FrustumCuller.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define GW_CULL_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+using namespace Renderer;
+
+namespace {
+	// padding/empty entries: a radius of -FLT_MAX puts them outside every plane
+	constexpr float NeverVisible = -FLT_MAX;
+}
+
+FrustumCuller::Planes FrustumCuller::ExtractPlanes(const glm::mat4& viewProj, bool zeroToOne) {
+	// rows of the (column-major) matrix
+	glm::vec4 row[4];
+	for (int r = 0; r < 4; ++r) {
+		row[r] = glm::vec4(viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]);
+	}
+
+	Planes out;
+	out.plane[0] = row[3] + row[0];   // left
+	out.plane[1] = row[3] - row[0];   // right
+	out.plane[2] = row[3] + row[1];   // bottom
+	out.plane[3] = row[3] - row[1];   // top
+	out.plane[4] = zeroToOne ? row[2] : row[3] + row[2];   // near
+	out.plane[5] = row[3] - row[2];   // far
+
+	for (glm::vec4& p : out.plane) {
+		float len = glm::length(glm::vec3(p));
+		if (len > 0.0f) p = p / len;
+	}
+	return out;
+}
+
+glm::mat4 FrustumCuller::DrawMatrix(const Transform& transform) {
+	glm::mat4 m = glm::translate(glm::mat4(1.0f), transform.position);
+	m = glm::rotate(m, glm::radians(transform.rotation.y), glm::vec3(0, 1, 0));
+	m = glm::rotate(m, glm::radians(transform.rotation.x), glm::vec3(1, 0, 0));
+	m = glm::rotate(m, glm::radians(transform.rotation.z), glm::vec3(0, 0, 1));
+	return m;
+}
+
+void FrustumCuller::Resize(size_t slotCount) {
+	size_t padded = (slotCount + 3) & ~size_t(3);
+	slots.resize(slotCount);
+	centerX.resize(padded, 0.0f);
+	centerY.resize(padded, 0.0f);
+	centerZ.resize(padded, 0.0f);
+	extentX.resize(padded, 0.0f);
+	extentY.resize(padded, 0.0f);
+	extentZ.resize(padded, 0.0f);
+	radius.resize(padded, NeverVisible);
+	for (size_t i = slotCount; i < padded; ++i) {
+		radius[i] = NeverVisible;
+	}
+}
+
+void FrustumCuller::Update(size_t slot, const MeshGeometry* geometry, const Transform& transform) {
+	if (slot >= slots.size()) {
+		Resize(slot + 1);
+	}
+	SlotState& state = slots[slot];
+	if (state.valid && state.geometry == geometry && state.transform == transform) {
+		return;
+	}
+	if (geometry && geometry != state.geometry) {
+		state.boundsMin = geometry->boundsMin;
+		state.boundsMax = geometry->boundsMax;
+	}
+	state.geometry  = geometry;
+	state.transform = transform;
+	state.valid     = true;
+
+	if (!geometry) {
+		centerX[slot] = centerY[slot] = centerZ[slot] = 0.0f;
+		extentX[slot] = extentY[slot] = extentZ[slot] = 0.0f;
+		radius[slot]  = NeverVisible;
+		return;
+	}
+
+	glm::vec3 localCenter = (state.boundsMin + state.boundsMax) * 0.5f;
+	glm::vec3 localExtent = (state.boundsMax - state.boundsMin) * 0.5f;
+	glm::mat4 m = DrawMatrix(transform);
+
+	// Arvo: the world AABB half extent along each axis is |M| * extent
+	glm::vec4 center = m * glm::vec4(localCenter, 1.0f);
+	glm::vec3 extent;
+	for (int axis = 0; axis < 3; ++axis) {
+		extent[axis] = std::fabs(m[0][axis]) * localExtent.x
+					 + std::fabs(m[1][axis]) * localExtent.y
+					 + std::fabs(m[2][axis]) * localExtent.z;
+	}
+
+	centerX[slot] = center.x;
+	centerY[slot] = center.y;
+	centerZ[slot] = center.z;
+	extentX[slot] = extent.x;
+	extentY[slot] = extent.y;
+	extentZ[slot] = extent.z;
+	radius[slot]  = glm::length(localExtent);   // rigid transform, length is kept
+}
+
+void FrustumCuller::Extend(const MeshGeometry& geometry, size_t first, size_t count) {
+	size_t end = std::min(first + count, geometry.VertexCount());
+	if (first >= end) {
+		return;
+	}
+	glm::vec3 editMin = geometry.Position(uint32_t(first));
+	glm::vec3 editMax = editMin;
+	for (size_t i = first + 1; i < end; ++i) {
+		glm::vec3 position = geometry.Position(uint32_t(i));
+		editMin = glm::min(editMin, position);
+		editMax = glm::max(editMax, position);
+	}
+	// buffers are shared per geometry, so every slot drawing it moved too;
+	// slots not seen yet take the geometry's bounds on their first Update
+	for (SlotState& state : slots) {
+		if (state.geometry == &geometry) {
+			state.boundsMin = glm::min(state.boundsMin, editMin);
+			state.boundsMax = glm::max(state.boundsMax, editMax);
+			state.valid     = false;
+		}
+	}
+}
+
+void FrustumCuller::Cull(const Planes& planes, std::vector<uint32_t>& visible) {
+	const size_t count  = slots.size();
+	const size_t padded = centerX.size();
+	size_t before = visible.size();
+
+	tested = 0;
+	for (size_t i = 0; i < count; ++i) {
+		if (slots[i].valid && slots[i].geometry) ++tested;
+	}
+
+#if GW_CULL_SSE2
+	__m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	for (int p = 0; p < 6; ++p) {
+		nx[p] = _mm_set1_ps(planes.plane[p].x);
+		ny[p] = _mm_set1_ps(planes.plane[p].y);
+		nz[p] = _mm_set1_ps(planes.plane[p].z);
+		nw[p] = _mm_set1_ps(planes.plane[p].w);
+		ax[p] = _mm_andnot_ps(signMask, nx[p]);
+		ay[p] = _mm_andnot_ps(signMask, ny[p]);
+		az[p] = _mm_andnot_ps(signMask, nz[p]);
+	}
+
+	for (size_t i = 0; i < padded; i += 4) {
+		__m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]);
+		__m128 ex = _mm_loadu_ps(&extentX[i]), ey = _mm_loadu_ps(&extentY[i]), ez = _mm_loadu_ps(&extentZ[i]);
+		__m128 rs = _mm_loadu_ps(&radius[i]);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < 6; ++p) {
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+								  _mm_add_ps(_mm_mul_ps(nz[p], cz), nw[p]));
+			__m128 boxR = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+			// whichever volume is tighter along this plane decides
+			__m128 r = _mm_min_ps(boxR, rs);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_xor_ps(r, signMask)));
+		}
+
+		int mask = ~_mm_movemask_ps(outside) & 0xF;
+		while (mask) {
+			int bit = 0;
+			while (!(mask & (1 << bit))) ++bit;
+			mask &= mask - 1;
+			if (i + bit < count) visible.push_back(static_cast<uint32_t>(i + bit));
+		}
+	}
+#else
+	for (size_t i = 0; i < count; ++i) {
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; ++p) {
+			const glm::vec4& pl = planes.plane[p];
+			float d    = pl.x * centerX[i] + pl.y * centerY[i] + pl.z * centerZ[i] + pl.w;
+			float boxR = std::fabs(pl.x) * extentX[i] + std::fabs(pl.y) * extentY[i] + std::fabs(pl.z) * extentZ[i];
+			float r    = boxR < radius[i] ? boxR : radius[i];
+			outside = d < -r;
+		}
+		if (!outside) visible.push_back(static_cast<uint32_t>(i));
+	}
+	(void)padded;
+#endif
+
+	culled = tested - static_cast<uint32_t>(visible.size() - before);
+}
@@ -0,0 +1,71 @@
+// FrustumCuller.h
+#pragma once
+
+#include "Mesh.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Renderer {
+
+// World-space bounds of every mesh slot, kept structure-of-arrays so the
+// culling pass can test four meshes per SSE instruction. Each slot has an
+// AABB (centre + half extents) and a bounding sphere with the same centre;
+// a mesh is culled when either volume is fully outside one frustum plane.
+class FrustumCuller {
+public:
+	struct Planes {
+		glm::vec4 plane[6];   // xyz = inward normal, w = distance; normalized
+	};
+
+	// Gribb/Hartmann extraction from a combined projection * view matrix.
+	// `zeroToOne` selects D3D clip depth (0..w) instead of GL (-w..w).
+	static Planes ExtractPlanes(const glm::mat4& viewProj, bool zeroToOne = false);
+
+	// The matrix the renderers draw a mesh with: translate, then yaw (Y),
+	// pitch (X), roll (Z) in degrees, as glRotatef / the DX9 world matrix do.
+	static glm::mat4 DrawMatrix(const Transform& transform);
+
+	void Resize(size_t slotCount);
+
+	// Refreshes the slot's bounds if its geometry or transform changed since
+	// the last call; null geometry makes the slot never visible.
+	void Update(size_t slot, const MeshGeometry* geometry, const Transform& transform);
+
+	// Grows the bounds of every slot drawing `geometry` over vertices
+	// [first, first + count) after they were edited in place, and has the
+	// next Update recompute them. Bounds only grow; a slot takes them from
+	// the geometry again once its geometry changes.
+	void Extend(const MeshGeometry& geometry, size_t first, size_t count);
+
+	// Appends the slots that may be visible to `visible`, in slot order.
+	void Cull(const Planes& planes, std::vector<uint32_t>& visible);
+
+	// World-space centre of the slot's bounds as of the last Update.
+	glm::vec3 Center(size_t slot) const { return glm::vec3(centerX[slot], centerY[slot], centerZ[slot]); }
+
+	uint32_t Tested() const { return tested; }
+	uint32_t Culled() const { return culled; }
+
+private:
+	struct SlotState {
+		const MeshGeometry* geometry = nullptr;
+		Transform           transform;
+		glm::vec3           boundsMin = glm::vec3(0.0f);   // local, geometry's plus edits
+		glm::vec3           boundsMax = glm::vec3(0.0f);
+		bool                valid = false;
+	};
+
+	std::vector<SlotState> slots;
+
+	// SoA, padded to a multiple of 4 with never-visible entries
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+	std::vector<float> radius;
+
+	uint32_t tested = 0;
+	uint32_t culled = 0;
+};
+
+}
@@ -0,0 +1,85 @@
+#include "GLDebugDraw.h"
+#include <algorithm>
+#include <cstddef>
+
+using namespace Renderer;
+
+GLDebugDraw::~GLDebugDraw() {
+	Release();
+}
+
+void GLDebugDraw::Release() {
+	if (buffer) GLExt::DeleteBuffers(1, &buffer);
+	buffer      = 0;
+	capacity    = 0;
+	initialized = false;
+}
+
+uint32_t GLDebugDraw::Draw(const DebugDrawList& list) {
+	size_t count = list.VertexCount();
+	if (!count) {
+		return 0;
+	}
+	if (!initialized) {
+		useVertexBuffers = GLExt::HasVertexBuffers();
+		initialized      = true;
+	}
+
+	// upload and draw order: each bucket's lines, then its triangles
+	const std::vector<DebugVertex>* parts[] = {
+		&list.Lines(DebugDrawList::Depth),   &list.Triangles(DebugDrawList::Depth),
+		&list.Lines(DebugDrawList::Overlay), &list.Triangles(DebugDrawList::Overlay),
+	};
+	if (useVertexBuffers) {
+		if (!buffer) {
+			GLExt::GenBuffers(1, &buffer);
+		}
+		GLExt::BindBuffer(GL_ARRAY_BUFFER, buffer);
+		// orphan the old storage; the size only ever grows, so the driver
+		// can recycle the same allocation frame after frame
+		capacity = std::max(capacity, count * sizeof(DebugVertex));
+		GLExt::BufferData(GL_ARRAY_BUFFER, GLExt::SizeiPtr(capacity), nullptr, GL_STREAM_DRAW);
+		size_t offset = 0;
+		for (const auto* part : parts) {
+			if (!part->empty()) {
+				GLExt::BufferSubData(GL_ARRAY_BUFFER, GLExt::IntPtr(offset), GLExt::SizeiPtr(part->size() * sizeof(DebugVertex)), part->data());
+			}
+			offset += part->size() * sizeof(DebugVertex);
+		}
+	}
+
+	glPushAttrib(GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_LIGHTING_BIT | GL_POLYGON_BIT | GL_CURRENT_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_TEXTURE_2D);
+	glDepthMask(GL_FALSE);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	uint32_t draws = 0;
+	size_t   first = 0;
+	for (int i = 0; i < 4; ++i) {
+		const std::vector<DebugVertex>& part = *parts[i];
+		if (!part.empty()) {
+			if (i < 2) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+			// with a buffer bound the pointers are offsets into it
+			const char* base = useVertexBuffers ? reinterpret_cast<const char*>(first * sizeof(DebugVertex))
+												: reinterpret_cast<const char*>(part.data());
+			glVertexPointer(3, GL_FLOAT, sizeof(DebugVertex), base + offsetof(DebugVertex, position));
+			glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(DebugVertex), base + offsetof(DebugVertex, color));
+			glDrawArrays(i % 2 ? GL_TRIANGLES : GL_LINES, 0, GLsizei(part.size()));
+			draws++;
+		}
+		first += part.size();
+	}
+
+	if (useVertexBuffers) {
+		GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	glPopClientAttrib();
+	glPopAttrib();
+	return draws;
+}
@@ -0,0 +1,36 @@
+// GLDebugDraw.h
+#pragma once
+
+#include "GLExtensions.h"
+#include "DebugDraw.h"
+
+namespace Renderer {
+
+// Draws a DebugDrawList for the GL 2.1 renderer. The whole list goes up
+// into one streaming vertex buffer, re-specified every frame so the driver
+// never waits on the previous frame's draws, and each non-empty line or
+// triangle list of a bucket is one glDrawArrays. Without buffer objects it
+// draws from the list's memory directly.
+class GLDebugDraw {
+public:
+	GLDebugDraw() = default;
+	GLDebugDraw(const GLDebugDraw&) = delete;
+	GLDebugDraw& operator=(const GLDebugDraw&) = delete;
+	~GLDebugDraw();
+
+	// Draws with the current matrices, unlit and unculled; the depth-tested
+	// bucket first, then the overlay. GL state is left as it was. Returns
+	// the number of draw calls.
+	uint32_t Draw(const DebugDrawList& list);
+
+	// Frees the buffer; the context that made it must be current.
+	void Release();
+
+private:
+	GLuint buffer   = 0;
+	size_t capacity = 0;
+	bool   useVertexBuffers = false;
+	bool   initialized      = false;
+};
+
+}
@@ -0,0 +1,201 @@
+#include "GLExtensions.h"
+#include "../Core/Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace GLExt {
+	GenBuffersProc    GenBuffers    = nullptr;
+	DeleteBuffersProc DeleteBuffers = nullptr;
+	BindBufferProc    BindBuffer    = nullptr;
+	BufferDataProc    BufferData    = nullptr;
+	BufferSubDataProc BufferSubData = nullptr;
+	MapBufferProc     MapBuffer     = nullptr;
+	UnmapBufferProc   UnmapBuffer   = nullptr;
+
+	GenObjectsProc              GenFramebuffers         = nullptr;
+	DeleteObjectsProc           DeleteFramebuffers      = nullptr;
+	BindObjectProc              BindFramebuffer         = nullptr;
+	GenObjectsProc              GenRenderbuffers        = nullptr;
+	DeleteObjectsProc           DeleteRenderbuffers     = nullptr;
+	BindObjectProc              BindRenderbuffer        = nullptr;
+	RenderbufferStorageProc     RenderbufferStorage     = nullptr;
+	FramebufferRenderbufferProc FramebufferRenderbuffer = nullptr;
+	CheckFramebufferStatusProc  CheckFramebufferStatus  = nullptr;
+	FramebufferTexture2DProc    FramebufferTexture2D    = nullptr;
+
+	CompressedTexImage2DProc CompressedTexImage2D = nullptr;
+
+	GenObjectsProc          GenQueries          = nullptr;
+	DeleteObjectsProc       DeleteQueries       = nullptr;
+	BeginQueryProc          BeginQuery          = nullptr;
+	EndQueryProc            EndQuery            = nullptr;
+	GetQueryObjectivProc    GetQueryObjectiv    = nullptr;
+	GetQueryObjectui64vProc GetQueryObjectui64v = nullptr;
+
+	namespace {
+		bool vertexBuffers = false;
+		bool pixelBuffers  = false;
+		bool framebuffers  = false;
+		bool s3tc          = false;
+		bool rgtc          = false;
+		bool timerQueries  = false;
+
+		ProcLoader loader = nullptr;
+
+		template <typename Proc>
+		void Resolve(Proc& out, const std::string& name, const char* suffix) {
+			std::string full = name + suffix;
+			if (loader) {
+				out = reinterpret_cast<Proc>(loader(full.c_str()));
+			} else {
+				out = reinterpret_cast<Proc>(glfwGetProcAddress(full.c_str()));
+			}
+		}
+
+		bool VersionAtLeast(int wantMajor, int wantMinor) {
+			const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+			int major = 0, minor = 0;
+			if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) {
+				return false;
+			}
+			return major > wantMajor || (major == wantMajor && minor >= wantMinor);
+		}
+	}
+
+	bool ExtensionSupported(const char* name) {
+		const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+		if (!extensions) {
+			return false;
+		}
+		// whole words only: GL_EXT_foo must not match GL_EXT_foo_bar
+		size_t length = strlen(name);
+		for (const char* at = strstr(extensions, name); at; at = strstr(at + 1, name)) {
+			bool start = at == extensions || at[-1] == ' ';
+			bool end   = at[length] == ' ' || at[length] == '\0';
+			if (start && end) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Load(ProcLoader getProcAddress) {
+		loader = getProcAddress;
+
+		// the core names need GL 1.5; older drivers may still have the ARB extension
+		const char* suffix = nullptr;
+		if (VersionAtLeast(1, 5)) {
+			suffix = "";
+		} else if (ExtensionSupported("GL_ARB_vertex_buffer_object")) {
+			suffix = "ARB";
+		}
+
+		if (suffix) {
+			Resolve(GenBuffers,    "glGenBuffers",    suffix);
+			Resolve(DeleteBuffers, "glDeleteBuffers", suffix);
+			Resolve(BindBuffer,    "glBindBuffer",    suffix);
+			Resolve(BufferData,    "glBufferData",    suffix);
+			Resolve(BufferSubData, "glBufferSubData", suffix);
+			Resolve(MapBuffer,     "glMapBuffer",     suffix);
+			Resolve(UnmapBuffer,   "glUnmapBuffer",   suffix);
+		}
+
+		vertexBuffers = GenBuffers && DeleteBuffers && BindBuffer && BufferData && BufferSubData;
+		if (vertexBuffers) {
+			Logger::Info(std::string("Using vertex buffer objects") + (*suffix ? " (ARB)." : "."));
+		} else {
+			Logger::Warn("Vertex buffer objects unavailable, falling back to client-side vertex arrays.");
+		}
+
+		pixelBuffers = vertexBuffers && MapBuffer && UnmapBuffer
+			&& (VersionAtLeast(2, 1) || ExtensionSupported("GL_ARB_pixel_buffer_object"));
+
+		// GL 2.1 only has framebuffers through an extension
+		const char* fboSuffix = nullptr;
+		if (VersionAtLeast(3, 0) || ExtensionSupported("GL_ARB_framebuffer_object")) {
+			fboSuffix = "";
+		} else if (ExtensionSupported("GL_EXT_framebuffer_object")) {
+			fboSuffix = "EXT";
+		}
+		if (fboSuffix) {
+			Resolve(GenFramebuffers,         "glGenFramebuffers",         fboSuffix);
+			Resolve(DeleteFramebuffers,      "glDeleteFramebuffers",      fboSuffix);
+			Resolve(BindFramebuffer,         "glBindFramebuffer",         fboSuffix);
+			Resolve(GenRenderbuffers,        "glGenRenderbuffers",        fboSuffix);
+			Resolve(DeleteRenderbuffers,     "glDeleteRenderbuffers",     fboSuffix);
+			Resolve(BindRenderbuffer,        "glBindRenderbuffer",        fboSuffix);
+			Resolve(RenderbufferStorage,     "glRenderbufferStorage",     fboSuffix);
+			Resolve(FramebufferRenderbuffer, "glFramebufferRenderbuffer", fboSuffix);
+			Resolve(CheckFramebufferStatus,  "glCheckFramebufferStatus",  fboSuffix);
+			Resolve(FramebufferTexture2D,    "glFramebufferTexture2D",    fboSuffix);
+		}
+		framebuffers = GenFramebuffers && DeleteFramebuffers && BindFramebuffer && GenRenderbuffers
+			&& DeleteRenderbuffers && BindRenderbuffer && RenderbufferStorage && FramebufferRenderbuffer
+			&& CheckFramebufferStatus && FramebufferTexture2D;
+
+		CompressedTexImage2D = nullptr;
+		if (VersionAtLeast(1, 3)) {
+			Resolve(CompressedTexImage2D, "glCompressedTexImage2D", "");
+		} else if (ExtensionSupported("GL_ARB_texture_compression")) {
+			Resolve(CompressedTexImage2D, "glCompressedTexImage2D", "ARB");
+		}
+		s3tc = CompressedTexImage2D && ExtensionSupported("GL_EXT_texture_compression_s3tc");
+		rgtc = CompressedTexImage2D && (VersionAtLeast(3, 0) || ExtensionSupported("GL_ARB_texture_compression_rgtc")
+										|| ExtensionSupported("GL_EXT_texture_compression_rgtc"));
+
+		const char* querySuffix = nullptr;
+		if (VersionAtLeast(1, 5)) {
+			querySuffix = "";
+		} else if (ExtensionSupported("GL_ARB_occlusion_query")) {
+			querySuffix = "ARB";
+		}
+		const char* timerSuffix = nullptr;
+		if (VersionAtLeast(3, 3) || ExtensionSupported("GL_ARB_timer_query")) {
+			timerSuffix = "";
+		} else if (ExtensionSupported("GL_EXT_timer_query")) {
+			timerSuffix = "EXT";
+		}
+		GenQueries          = nullptr;
+		DeleteQueries       = nullptr;
+		BeginQuery          = nullptr;
+		EndQuery            = nullptr;
+		GetQueryObjectiv    = nullptr;
+		GetQueryObjectui64v = nullptr;
+		if (querySuffix) {
+			Resolve(GenQueries,       "glGenQueries",       querySuffix);
+			Resolve(DeleteQueries,    "glDeleteQueries",    querySuffix);
+			Resolve(BeginQuery,       "glBeginQuery",       querySuffix);
+			Resolve(EndQuery,         "glEndQuery",         querySuffix);
+			Resolve(GetQueryObjectiv, "glGetQueryObjectiv", querySuffix);
+		}
+		if (querySuffix && timerSuffix) {
+			Resolve(GetQueryObjectui64v, "glGetQueryObjectui64v", timerSuffix);
+		}
+		timerQueries = GenQueries && DeleteQueries && BeginQuery && EndQuery && GetQueryObjectiv && GetQueryObjectui64v;
+	}
+
+	bool HasVertexBuffers() {
+		return vertexBuffers;
+	}
+
+	bool HasPixelBuffers() {
+		return pixelBuffers;
+	}
+
+	bool HasFramebuffers() {
+		return framebuffers;
+	}
+
+	bool HasS3TC() {
+		return s3tc;
+	}
+
+	bool HasRGTC() {
+		return rgtc;
+	}
+
+	bool HasTimerQueries() {
+		return timerQueries;
+	}
+}
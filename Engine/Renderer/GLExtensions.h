@@ -0,0 +1,154 @@
+// GLExtensions.h
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+
+// Entry points past OpenGL 1.1 are not exported by every platform's GL
+// library (opengl32.dll stops at 1.1), so they are fetched through GLFW (or
+// whoever owns the context) once a context is current. Only what the GL 2.1
+// renderer uses is listed here.
+
+#if defined(_WIN32)
+	#define GW_GLAPI __stdcall
+#else
+	#define GW_GLAPI
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+	#define GL_ARRAY_BUFFER         0x8892
+	#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+	#define GL_STATIC_DRAW          0x88E4
+#endif
+#ifndef GL_TEXTURE_MAX_LEVEL
+	#define GL_TEXTURE_MAX_LEVEL    0x813D
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+	#define GL_CLAMP_TO_EDGE        0x812F
+#endif
+#ifndef GL_STREAM_DRAW
+	#define GL_STREAM_DRAW          0x88E0
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+	#define GL_PIXEL_PACK_BUFFER    0x88EB
+	#define GL_STREAM_READ          0x88E1
+	#define GL_READ_ONLY            0x88B8
+#endif
+#ifndef GL_FRAMEBUFFER
+	#define GL_FRAMEBUFFER          0x8D40
+	#define GL_RENDERBUFFER         0x8D41
+	#define GL_COLOR_ATTACHMENT0    0x8CE0
+	#define GL_DEPTH_ATTACHMENT     0x8D00
+	#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+	#define GL_FRAMEBUFFER_BINDING  0x8CA6
+#endif
+#ifndef GL_TEXTURE_RECTANGLE_ARB
+	#define GL_TEXTURE_RECTANGLE_ARB         0x84F5
+	#define GL_TEXTURE_BINDING_RECTANGLE_ARB 0x84F6
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+	#define GL_COMPRESSED_RG_RGTC2           0x8DBD
+#endif
+#ifndef GL_QUERY_RESULT
+	#define GL_QUERY_RESULT           0x8866
+	#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_TIME_ELAPSED
+	#define GL_TIME_ELAPSED         0x88BF
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+	#define GL_DEPTH_COMPONENT24    0x81A6
+#endif
+
+namespace GLExt {
+	using SizeiPtr = ptrdiff_t;
+	using IntPtr   = ptrdiff_t;
+
+	typedef void (GW_GLAPI *GenBuffersProc)(GLsizei n, GLuint* buffers);
+	typedef void (GW_GLAPI *DeleteBuffersProc)(GLsizei n, const GLuint* buffers);
+	typedef void (GW_GLAPI *BindBufferProc)(GLenum target, GLuint buffer);
+	typedef void (GW_GLAPI *BufferDataProc)(GLenum target, SizeiPtr size, const void* data, GLenum usage);
+	typedef void (GW_GLAPI *BufferSubDataProc)(GLenum target, IntPtr offset, SizeiPtr size, const void* data);
+	typedef void* (GW_GLAPI *MapBufferProc)(GLenum target, GLenum access);
+	typedef GLboolean (GW_GLAPI *UnmapBufferProc)(GLenum target);
+	typedef void (GW_GLAPI *GenObjectsProc)(GLsizei n, GLuint* objects);
+	typedef void (GW_GLAPI *DeleteObjectsProc)(GLsizei n, const GLuint* objects);
+	typedef void (GW_GLAPI *BindObjectProc)(GLenum target, GLuint object);
+	typedef void (GW_GLAPI *RenderbufferStorageProc)(GLenum target, GLenum format, GLsizei width, GLsizei height);
+	typedef void (GW_GLAPI *FramebufferRenderbufferProc)(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer);
+	typedef GLenum (GW_GLAPI *CheckFramebufferStatusProc)(GLenum target);
+	typedef void (GW_GLAPI *FramebufferTexture2DProc)(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level);
+	typedef void (GW_GLAPI *CompressedTexImage2DProc)(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+													  GLint border, GLsizei imageSize, const void* data);
+
+	typedef void (GW_GLAPI *BeginQueryProc)(GLenum target, GLuint query);
+	typedef void (GW_GLAPI *EndQueryProc)(GLenum target);
+	typedef void (GW_GLAPI *GetQueryObjectivProc)(GLuint query, GLenum name, GLint* value);
+	typedef void (GW_GLAPI *GetQueryObjectui64vProc)(GLuint query, GLenum name, uint64_t* value);
+
+	// Looks up an entry point in the current context, e.g. SDL_GL_GetProcAddress.
+	typedef void* (*ProcLoader)(const char* name);
+
+	// ARB_vertex_buffer_object (core in GL 1.5)
+	extern GenBuffersProc    GenBuffers;
+	extern DeleteBuffersProc DeleteBuffers;
+	extern BindBufferProc    BindBuffer;
+	extern BufferDataProc    BufferData;
+	extern BufferSubDataProc BufferSubData;
+	extern MapBufferProc     MapBuffer;
+	extern UnmapBufferProc   UnmapBuffer;
+
+	// ARB_framebuffer_object (core in GL 3.0) or EXT_framebuffer_object
+	extern GenObjectsProc              GenFramebuffers;
+	extern DeleteObjectsProc           DeleteFramebuffers;
+	extern BindObjectProc              BindFramebuffer;
+	extern GenObjectsProc              GenRenderbuffers;
+	extern DeleteObjectsProc           DeleteRenderbuffers;
+	extern BindObjectProc              BindRenderbuffer;
+	extern RenderbufferStorageProc     RenderbufferStorage;
+	extern FramebufferRenderbufferProc FramebufferRenderbuffer;
+	extern CheckFramebufferStatusProc  CheckFramebufferStatus;
+	extern FramebufferTexture2DProc    FramebufferTexture2D;
+
+	// ARB_texture_compression (core in GL 1.3)
+	extern CompressedTexImage2DProc CompressedTexImage2D;
+
+	// query objects (core in GL 1.5, else ARB_occlusion_query); the 64-bit
+	// result from ARB_timer_query (core in GL 3.3) or EXT_timer_query
+	extern GenObjectsProc          GenQueries;
+	extern DeleteObjectsProc       DeleteQueries;
+	extern BeginQueryProc          BeginQuery;
+	extern EndQueryProc            EndQuery;
+	extern GetQueryObjectivProc    GetQueryObjectiv;
+	extern GetQueryObjectui64vProc GetQueryObjectui64v;
+
+	// Resolves everything above for the current context. Safe to call again.
+	// Without a loader the context is taken to be GLFW's.
+	void Load(ProcLoader loader = nullptr);
+
+	// Looks `name` up in the current context's extension string.
+	bool ExtensionSupported(const char* name);
+
+	// True when the buffer object entry points were all found.
+	bool HasVertexBuffers();
+
+	// True when buffers can be bound to GL_PIXEL_PACK_BUFFER and mapped
+	// (GL 2.1 or ARB_pixel_buffer_object).
+	bool HasPixelBuffers();
+
+	// True when offscreen framebuffers with renderbuffer attachments work.
+	bool HasFramebuffers();
+
+	// True when BC1/BC3 (EXT_texture_compression_s3tc) or BC5
+	// (RGTC, core in GL 3.0) blocks can be uploaded as they are.
+	bool HasS3TC();
+	bool HasRGTC();
+
+	// True when GL_TIME_ELAPSED queries measure GPU time.
+	bool HasTimerQueries();
+}
@@ -0,0 +1,120 @@
+#include "GLFrameReadback.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace Renderer;
+
+GLFrameReadback::~GLFrameReadback() {
+	Release();
+}
+
+void GLFrameReadback::Release() {
+	for (Slot& slot : slots) {
+		if (slot.buffer) GLExt::DeleteBuffers(1, &slot.buffer);
+		slot = Slot();
+	}
+	client.clear();
+	client.shrink_to_fit();
+	initialized = false;
+}
+
+void GLFrameReadback::Queue(int width, int height, bool topDown) {
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+	if (!initialized) {
+		usePixelBuffers = GLExt::HasPixelBuffers();
+		initialized     = true;
+	}
+
+	double start = glfwGetTime();
+	size_t bytes = size_t(width) * height * 4;
+	if (!usePixelBuffers) {
+		client.resize(bytes);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, client.data());
+		clientWidth   = width;
+		clientHeight  = height;
+		clientTopDown = topDown;
+		queueMs = static_cast<float>((glfwGetTime() - start) * 1000.0);
+		return;
+	}
+
+	// a slot nobody collected in time is simply overwritten
+	Slot& slot = slots[next];
+	next = (next + 1) % RingSize;
+	if (!slot.buffer) {
+		GLExt::GenBuffers(1, &slot.buffer);
+	}
+	GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	if (slot.capacity < bytes) {
+		GLExt::BufferData(GL_PIXEL_PACK_BUFFER, GLExt::SizeiPtr(bytes), nullptr, GL_STREAM_READ);
+		slot.capacity = bytes;
+	}
+	// with a pack buffer bound the pointer is an offset and the call returns at once
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.width    = width;
+	slot.height   = height;
+	slot.topDown  = topDown;
+	slot.sequence = ++sequence;
+	queueMs = static_cast<float>((glfwGetTime() - start) * 1000.0);
+}
+
+bool GLFrameReadback::Collect(ImageData& out) {
+	collectMs = 0.0f;
+	if (!usePixelBuffers) {
+		if (client.empty()) {
+			return false;
+		}
+		// hand the storage over instead of copying, then flip it in place
+		out.pixels.swap(client);
+		out.width  = clientWidth;
+		out.height = clientHeight;
+		client.clear();
+		size_t row = size_t(out.width) * 4;
+		for (int y = 0; !clientTopDown && y < out.height / 2; ++y) {
+			unsigned char* top    = out.pixels.data() + y * row;
+			unsigned char* bottom = out.pixels.data() + (out.height - 1 - y) * row;
+			std::swap_ranges(top, top + row, bottom);
+		}
+		return true;
+	}
+
+	// the oldest waiting frame, as long as a newer one is queued behind it:
+	// mapping the newest would wait for the frame just submitted
+	Slot* oldest  = nullptr;
+	int   waiting = 0;
+	for (Slot& slot : slots) {
+		if (slot.sequence) {
+			waiting++;
+			if (!oldest || slot.sequence < oldest->sequence) {
+				oldest = &slot;
+			}
+		}
+	}
+	if (waiting < 2) {
+		return false;
+	}
+
+	double start = glfwGetTime();
+	GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, oldest->buffer);
+	const unsigned char* mapped = static_cast<const unsigned char*>(GLExt::MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+	collectMs = static_cast<float>((glfwGetTime() - start) * 1000.0);
+	bool ok = mapped != nullptr;
+	if (ok) {
+		// GL rows run bottom-up; copying them out in reverse is the flip
+		size_t row = size_t(oldest->width) * 4;
+		out.width  = oldest->width;
+		out.height = oldest->height;
+		out.pixels.resize(row * oldest->height);
+		for (int y = 0; y < oldest->height; ++y) {
+			int source = oldest->topDown ? y : oldest->height - 1 - y;
+			memcpy(out.pixels.data() + y * row, mapped + size_t(source) * row, row);
+		}
+		GLExt::UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	oldest->sequence = 0;
+	return ok;
+}
@@ -0,0 +1,65 @@
+// GLFrameReadback.h
+#pragma once
+
+#include "GLExtensions.h"
+#include "IRenderer.h"
+#include <vector>
+#include <cstdint>
+
+namespace Renderer {
+
+// Reads rendered frames back without waiting on the GPU. Each frame is read
+// into the next of a ring of pixel-pack buffers just before it's presented,
+// and Collect maps the one queued before it, which the GPU has had a whole
+// frame to finish. Without pixel buffers it falls back to glReadPixels into
+// client memory, which stalls as before.
+class GLFrameReadback {
+public:
+	static const int RingSize = 3;
+
+	GLFrameReadback() = default;
+	GLFrameReadback(const GLFrameReadback&) = delete;
+	GLFrameReadback& operator=(const GLFrameReadback&) = delete;
+	~GLFrameReadback();
+
+	// Starts reading the current read buffer; call before swapping.
+	// `topDown` when the frame was drawn upside down, rows already in
+	// image order.
+	void Queue(int width, int height, bool topDown = false);
+
+	// Copies the oldest queued frame into `out`, top row first, reusing its
+	// storage. Leaves `out` alone and returns false when nothing is ready.
+	bool Collect(ImageData& out);
+
+	// Frees the buffers; the context that made them must be current.
+	void Release();
+
+	// Time the last Queue and Collect spent waiting on the GPU: the whole
+	// read in the fallback, otherwise issuing the read and mapping the result.
+	float StallMs() const { return queueMs + collectMs; }
+
+private:
+	struct Slot {
+		GLuint   buffer   = 0;
+		size_t   capacity = 0;
+		int      width    = 0;
+		int      height   = 0;
+		uint64_t sequence = 0;   // 0 while nothing is waiting in it
+		bool     topDown  = false;
+	};
+
+	Slot     slots[RingSize];
+	int      next     = 0;
+	uint64_t sequence = 0;
+	bool     usePixelBuffers = false;
+	bool     initialized     = false;
+	// synchronous fallback: the frame read last, bottom row first
+	std::vector<unsigned char> client;
+	int      clientWidth  = 0;
+	int      clientHeight = 0;
+	bool     clientTopDown = false;
+	float    queueMs   = 0.0f;
+	float    collectMs = 0.0f;
+};
+
+}
@@ -0,0 +1,87 @@
+#include "GLFrameTimer.h"
+
+using namespace Renderer;
+
+GLFrameTimer::~GLFrameTimer() {
+	Release();
+}
+
+void GLFrameTimer::Release() {
+	for (Slot& slot : slots) {
+		if (slot.query) GLExt::DeleteQueries(1, &slot.query);
+		slot = Slot();
+	}
+	next        = 0;
+	running     = false;
+	cpuReady    = false;
+	initialized = false;
+}
+
+void GLFrameTimer::Begin() {
+	if (!initialized) {
+		useQueries  = GLExt::HasTimerQueries();
+		initialized = true;
+	}
+	if (running) {
+		return;
+	}
+	running = true;
+	if (!useQueries) {
+		cpuStart = glfwGetTime();
+		return;
+	}
+
+	// a slot the GPU is still behind on is simply reused
+	Slot& slot = slots[next];
+	if (!slot.query) {
+		GLExt::GenQueries(1, &slot.query);
+	}
+	GLExt::BeginQuery(GL_TIME_ELAPSED, slot.query);
+	slot.pending = true;
+}
+
+void GLFrameTimer::End() {
+	if (!running) {
+		return;
+	}
+	running = false;
+	if (!useQueries) {
+		glFinish();
+		cpuMs    = static_cast<float>((glfwGetTime() - cpuStart) * 1000.0);
+		cpuReady = true;
+		return;
+	}
+	GLExt::EndQuery(GL_TIME_ELAPSED);
+	next = (next + 1) % RingSize;
+}
+
+bool GLFrameTimer::Collect(float& ms) {
+	if (!useQueries) {
+		if (!cpuReady) {
+			return false;
+		}
+		ms       = cpuMs;
+		cpuReady = false;
+		return true;
+	}
+
+	// results come back in order, so stop at the first one still in flight
+	bool found = false;
+	for (int i = 0; i < RingSize; ++i) {
+		Slot& slot = slots[(next + i) % RingSize];
+		if (!slot.pending || (running && &slot == &slots[next])) {
+			continue;
+		}
+		GLint available = 0;
+		GLExt::GetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			break;
+		}
+		uint64_t nanoseconds = 0;
+		GLExt::GetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &nanoseconds);
+		slot.pending = false;
+		ms    = static_cast<float>(nanoseconds / 1.0e6);
+		found = true;
+	}
+	return found;
+}
@@ -0,0 +1,50 @@
+// GLFrameTimer.h
+#pragma once
+
+#include "GLExtensions.h"
+
+namespace Renderer {
+
+// Measures how long the GPU spends between Begin and End without waiting
+// for it. Each measurement goes into the next of a ring of GL_TIME_ELAPSED
+// queries and Collect picks up whichever have finished, typically a frame
+// or two later. Without timer queries End calls glFinish and the CPU time
+// is taken instead; that stalls a hardware GPU, but a software rasterizer
+// does its work right there anyway.
+class GLFrameTimer {
+public:
+	static const int RingSize = 4;
+
+	GLFrameTimer() = default;
+	GLFrameTimer(const GLFrameTimer&) = delete;
+	GLFrameTimer& operator=(const GLFrameTimer&) = delete;
+	~GLFrameTimer();
+
+	void Begin();
+	void End();
+
+	// The newest measurement that finished since the last call, in ms.
+	// Leaves `ms` alone and returns false when none has.
+	bool Collect(float& ms);
+
+	// Frees the queries; the context that made them must be current.
+	void Release();
+
+private:
+	struct Slot {
+		GLuint query   = 0;
+		bool   pending = false;
+	};
+
+	Slot   slots[RingSize];
+	int    next        = 0;   // the slot Begin uses; the oldest pending one follows it
+	bool   useQueries  = false;
+	bool   initialized = false;
+	bool   running     = false;
+	// fallback: CPU time up to a glFinish
+	double cpuStart = 0.0;
+	float  cpuMs    = 0.0f;
+	bool   cpuReady = false;
+};
+
+}
@@ -0,0 +1,161 @@
+#include "GLMeshBuffers.h"
+#include "VertexPacking.h"
+#include "../Core/Logger.h"
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+
+using namespace Renderer;
+
+namespace {
+	// with a buffer object bound, GL takes byte offsets where pointers would go
+	const void* At(const uint8_t* base, size_t offset) {
+		return base ? static_cast<const void*>(base + offset) : reinterpret_cast<const void*>(offset);
+	}
+
+	// float meshes go up as-is, packed ones get their normals expanded
+	void WriteVertices(const MeshGeometry& geo, size_t first, size_t count, uint8_t* out) {
+		if (!geo.IsPacked()) {
+			memcpy(out, geo.vertices.data() + first, count * sizeof(Vertex));
+			return;
+		}
+
+		glm::vec3 normalScale = geo.DequantizeScale();
+		GLPackedVertex* verts = reinterpret_cast<GLPackedVertex*>(out);
+		for (size_t i = 0; i < count; ++i) {
+			const PackedVertex& src = geo.packed[first + i];
+			memcpy(verts[i].position, src.position, sizeof(src.position));
+			verts[i].position[3] = 0;
+
+			glm::vec3 n = VertexPacking::OctDecode(src.normal) * normalScale;
+			float len = glm::length(n);
+			if (len > 0.0f) n /= len;
+			for (int c = 0; c < 3; ++c) {
+				verts[i].normal[c] = int8_t(std::lround(n[c] * VertexPacking::SnormMax8));
+			}
+			verts[i].normal[3] = 0;
+		}
+	}
+}
+
+GLMeshBuffers::~GLMeshBuffers() {
+	if (vertexBuffer) GLExt::DeleteBuffers(1, &vertexBuffer);
+	if (indexBuffer)  GLExt::DeleteBuffers(1, &indexBuffer);
+}
+
+std::shared_ptr<GLMeshBuffers> GLMeshBuffers::Create(const std::shared_ptr<const MeshGeometry>& geometry, bool useVertexBuffers) {
+	const MeshGeometry& geo = *geometry;
+	static uint32_t nextId = 0;
+	auto buffers = std::make_shared<GLMeshBuffers>();
+	buffers->id          = ++nextId;
+	buffers->source      = geometry;
+	buffers->packed      = geo.IsPacked();
+	buffers->vertexCount = static_cast<int>(geo.VertexCount());
+
+	buffers->stride = buffers->packed ? sizeof(GLPackedVertex) : sizeof(Vertex);
+	std::vector<uint8_t> vertexData(size_t(buffers->vertexCount) * buffers->stride);
+	WriteVertices(geo, 0, buffers->vertexCount, vertexData.data());
+
+	// indices: 16-bit whenever they fit
+	bool index32 = buffers->vertexCount > 0xFFFF;
+	size_t indexSize = index32 ? sizeof(uint32_t) : sizeof(uint16_t);
+	buffers->indexType = index32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	buffers->lodLevels = static_cast<int>(geo.LodCount());
+
+	size_t indexCount = 0;
+	for (int level = 0; level < buffers->lodLevels; ++level) {
+		buffers->lodOffset[level]     = indexCount * indexSize;
+		buffers->lodIndexCount[level] = static_cast<GLsizei>(geo.LodIndices(level).size());
+		indexCount += buffers->lodIndexCount[level];
+	}
+
+	std::vector<uint8_t> indexData(indexCount * indexSize);
+	for (int level = 0; level < buffers->lodLevels; ++level) {
+		const std::vector<uint32_t>& lodIndices = geo.LodIndices(level);
+		uint8_t* dst = indexData.data() + buffers->lodOffset[level];
+		if (index32) {
+			memcpy(dst, lodIndices.data(), lodIndices.size() * sizeof(uint32_t));
+		} else {
+			uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+			for (size_t i = 0; i < lodIndices.size(); ++i) {
+				out[i] = static_cast<uint16_t>(lodIndices[i]);
+			}
+		}
+	}
+
+	if (!useVertexBuffers) {
+		buffers->clientVertices.swap(vertexData);
+		buffers->clientIndices.swap(indexData);
+		return buffers;
+	}
+
+	GLExt::GenBuffers(1, &buffers->vertexBuffer);
+	GLExt::BindBuffer(GL_ARRAY_BUFFER, buffers->vertexBuffer);
+	GLExt::BufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+
+	GLExt::GenBuffers(1, &buffers->indexBuffer);
+	GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->indexBuffer);
+	GLExt::BufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size(), indexData.data(), GL_STATIC_DRAW);
+
+	Unbind();
+
+	if (glGetError() == GL_OUT_OF_MEMORY) {
+		Logger::Error("Out of memory uploading mesh buffers");
+		return nullptr;
+	}
+	return buffers;
+}
+
+bool GLMeshBuffers::UpdateVertices(size_t first, size_t count) {
+	if (first + count > size_t(vertexCount) || first + count > source->VertexCount()) {
+		Logger::Error("Mesh vertex range out of bounds");
+		return false;
+	}
+	if (count == 0) {
+		return true;
+	}
+
+	if (!vertexBuffer) {
+		WriteVertices(*source, first, count, clientVertices.data() + first * stride);
+		return true;
+	}
+
+	std::vector<uint8_t> vertexData(count * stride);
+	WriteVertices(*source, first, count, vertexData.data());
+	GLExt::BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	GLExt::BufferSubData(GL_ARRAY_BUFFER, first * stride, vertexData.size(), vertexData.data());
+	GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+	return true;
+}
+
+void GLMeshBuffers::Bind() const {
+	const uint8_t* base = nullptr;
+	if (vertexBuffer) {
+		GLExt::BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	} else {
+		base = clientVertices.data();
+	}
+
+	if (packed) {
+		glVertexPointer(3, GL_SHORT, stride, At(base, offsetof(GLPackedVertex, position)));
+		glNormalPointer(GL_BYTE, stride, At(base, offsetof(GLPackedVertex, normal)));
+	} else {
+		glVertexPointer(3, GL_FLOAT, stride, At(base, offsetof(Vertex, position)));
+		glNormalPointer(GL_FLOAT, stride, At(base, offsetof(Vertex, normal)));
+		glTexCoordPointer(2, GL_FLOAT, stride, At(base, offsetof(Vertex, texcoord)));
+	}
+}
+
+void GLMeshBuffers::Draw(size_t lod) const {
+	if (lod >= size_t(lodLevels)) lod = 0;
+	const uint8_t* base = indexBuffer ? nullptr : clientIndices.data();
+	glDrawElements(GL_TRIANGLES, lodIndexCount[lod], indexType, At(base, lodOffset[lod]));
+}
+
+void GLMeshBuffers::Unbind() {
+	if (GLExt::HasVertexBuffers()) {
+		GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+		GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+}
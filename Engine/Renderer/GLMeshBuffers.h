@@ -0,0 +1,61 @@
+// GLMeshBuffers.h
+#pragma once
+
+#include "GLExtensions.h"
+#include "Mesh.h"
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace Renderer {
+
+// Vertex layout the fixed-function path reads from packed geometry: the
+// snorm16 position as-is (dequantized by the modelview) and the octahedral
+// normal expanded to snorm8, pre-scaled for that same matrix.
+struct GLPackedVertex {
+	int16_t position[4];
+	int8_t  normal[4];
+};
+static_assert(sizeof(GLPackedVertex) == 12, "GLPackedVertex layout changed");
+
+// One geometry's vertices and all of its LOD index lists, uploaded once and
+// shared by every Mesh that draws that geometry. Without VBO support the same
+// data stays in client memory and is drawn through plain vertex arrays.
+struct GLMeshBuffers {
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer  = 0;
+	std::vector<uint8_t> clientVertices;   // only used without VBOs
+	std::vector<uint8_t> clientIndices;
+
+	bool    packed      = false;
+	GLsizei stride      = 0;
+	GLenum  indexType   = GL_UNSIGNED_SHORT;
+	int     vertexCount = 0;
+	// every LOD level lives in the same index buffer, back to back
+	int     lodLevels = 0;
+	size_t  lodOffset[MaxMeshLods] = {};       // bytes
+	GLsizei lodIndexCount[MaxMeshLods] = {};
+
+	std::shared_ptr<const MeshGeometry> source;
+	uint32_t id = 0;   // unique per buffer set, used in draw sort keys
+
+	GLMeshBuffers() = default;
+	GLMeshBuffers(const GLMeshBuffers&) = delete;
+	GLMeshBuffers& operator=(const GLMeshBuffers&) = delete;
+	~GLMeshBuffers();
+
+	// Converts and uploads `geometry`; a GL context must be current.
+	static std::shared_ptr<GLMeshBuffers> Create(const std::shared_ptr<const MeshGeometry>& geometry, bool useVertexBuffers);
+
+	// Re-converts vertices [first, first + count) of `source` into the buffer.
+	bool UpdateVertices(size_t first, size_t count);
+
+	// Sets the vertex/normal arrays, and texcoords when unpacked. The caller
+	// enables GL_VERTEX_ARRAY and GL_NORMAL_ARRAY once per frame, and
+	// GL_TEXTURE_COORD_ARRAY only for textured draws.
+	void Bind() const;
+	void Draw(size_t lod) const;
+	static void Unbind();
+};
+
+}
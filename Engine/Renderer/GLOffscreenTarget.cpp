@@ -0,0 +1,87 @@
+#include "GLOffscreenTarget.h"
+#include "../Core/Logger.h"
+#include <string>
+
+using namespace Renderer;
+
+GLOffscreenTarget::~GLOffscreenTarget() {
+	Release();
+}
+
+bool GLOffscreenTarget::Resize(int newWidth, int newHeight) {
+	if (!GLExt::HasFramebuffers() || newWidth <= 0 || newHeight <= 0) {
+		return false;
+	}
+	if (!framebuffer) {
+		GLExt::GenFramebuffers(1, &framebuffer);
+		GLExt::GenRenderbuffers(1, &depth);
+	}
+	if (!color) {
+		GLExt::GenRenderbuffers(1, &color);
+	}
+	external = 0;
+
+	GLExt::BindRenderbuffer(GL_RENDERBUFFER, color);
+	GLExt::RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, newWidth, newHeight);
+	GLExt::BindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	GLExt::FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+	return Finish(newWidth, newHeight);
+}
+
+bool GLOffscreenTarget::Attach(GLuint texture, GLenum target, int newWidth, int newHeight) {
+	if (!GLExt::HasFramebuffers() || !texture || newWidth <= 0 || newHeight <= 0) {
+		return false;
+	}
+	if (!framebuffer) {
+		GLExt::GenFramebuffers(1, &framebuffer);
+		GLExt::GenRenderbuffers(1, &depth);
+	}
+	if (color) {
+		GLExt::DeleteRenderbuffers(1, &color);
+		color = 0;
+	}
+	external = texture;
+
+	GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, texture, 0);
+	return Finish(newWidth, newHeight);
+}
+
+// Sizes the depth buffer to match and checks the result; expects the
+// framebuffer bound.
+bool GLOffscreenTarget::Finish(int newWidth, int newHeight) {
+	GLExt::BindRenderbuffer(GL_RENDERBUFFER, depth);
+	GLExt::RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, newWidth, newHeight);
+	GLExt::BindRenderbuffer(GL_RENDERBUFFER, 0);
+	GLExt::FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+	GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		Logger::Error("Offscreen framebuffer incomplete (status " + std::to_string(status) + ").");
+		Unbind();
+		Release();
+		return false;
+	}
+
+	width  = newWidth;
+	height = newHeight;
+	return true;
+}
+
+void GLOffscreenTarget::Release() {
+	if (framebuffer) GLExt::DeleteFramebuffers(1, &framebuffer);
+	if (color)       GLExt::DeleteRenderbuffers(1, &color);
+	if (depth)       GLExt::DeleteRenderbuffers(1, &depth);
+	framebuffer = color = depth = external = 0;
+	width = height = 0;
+}
+
+void GLOffscreenTarget::Bind() const {
+	GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void GLOffscreenTarget::Unbind() {
+	GLExt::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
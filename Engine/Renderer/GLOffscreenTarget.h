@@ -0,0 +1,47 @@
+// GLOffscreenTarget.h
+#pragma once
+
+#include "GLExtensions.h"
+
+namespace Renderer {
+
+// A framebuffer with a colour and a depth renderbuffer, for rendering
+// without a window. Resizing only reallocates the two attachments. The
+// colour can also be a texture someone else owns, see Attach.
+class GLOffscreenTarget {
+public:
+	GLOffscreenTarget() = default;
+	GLOffscreenTarget(const GLOffscreenTarget&) = delete;
+	GLOffscreenTarget& operator=(const GLOffscreenTarget&) = delete;
+	~GLOffscreenTarget();
+
+	// (Re)allocates the attachments; a GL context must be current. False if
+	// the driver has no framebuffer objects or rejects the combination.
+	bool Resize(int width, int height);
+	// Renders into `texture` (GL_TEXTURE_2D or GL_TEXTURE_RECTANGLE_ARB,
+	// `width` x `height`) instead of an own colour buffer. The texture
+	// stays its owner's; it must outlive the attachment or be replaced.
+	bool Attach(GLuint texture, GLenum target, int width, int height);
+	void Release();
+
+	// Makes this the draw and read target; Unbind goes back to the window.
+	void Bind() const;
+	static void Unbind();
+
+	int  Width() const  { return width; }
+	int  Height() const { return height; }
+	bool Valid() const  { return framebuffer != 0; }
+	bool External() const { return external != 0; }
+
+private:
+	bool Finish(int width, int height);
+
+	GLuint framebuffer = 0;
+	GLuint color       = 0;
+	GLuint depth       = 0;
+	GLuint external    = 0;   // attached texture, not ours to delete
+	int    width       = 0;
+	int    height      = 0;
+};
+
+}
@@ -0,0 +1,90 @@
+#include "GeometryCache.h"
+#include "../Core/Logger.h"
+
+namespace fs = std::filesystem;
+
+std::mutex                                                                                 GeometryCache::mutex;
+std::unordered_map<GeometryCache::FileKey, std::weak_ptr<const MeshGeometry>, GeometryCache::FileKeyHash> GeometryCache::geometry;
+std::unordered_map<GeometryCache::FileKey, std::shared_future<std::shared_ptr<const MeshGeometry>>, GeometryCache::FileKeyHash> GeometryCache::loading;
+
+std::shared_ptr<const MeshGeometry> GeometryCache::Load(const std::string& path, uint32_t flags) {
+	// key on what will actually be read, so a cook is never handed out for
+	// another file and nothing has to be read to find the key
+	std::string file = MeshGeometry::FileToLoad(path);
+
+	std::error_code ec;
+	FileKey key;
+	key.path = fs::weakly_canonical(file, ec).string();
+	if (ec) {
+		key.path = fs::absolute(file, ec).lexically_normal().string();
+	}
+	key.size = fs::file_size(file, ec);
+	if (ec) {
+		Logger::Error("Failed to open mesh: " + path);
+		return nullptr;
+	}
+	key.writeTime = fs::last_write_time(file, ec).time_since_epoch().count();
+	key.flags     = flags;
+
+	std::promise<std::shared_ptr<const MeshGeometry>> promise;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		auto found = geometry.find(key);
+		if (found != geometry.end()) {
+			if (auto shared = found->second.lock()) {
+				Logger::Info("Geometry cache hit: " + path);
+				return shared;
+			}
+			geometry.erase(found);
+		}
+
+		auto inFlight = loading.find(key);
+		if (inFlight != loading.end()) {
+			auto pending = inFlight->second;
+			lock.unlock();
+			return pending.get();
+		}
+		loading.emplace(key, promise.get_future().share());
+	}
+
+	// load outside the lock; other threads asking for this file wait on the promise
+	auto loaded = std::make_shared<MeshGeometry>();
+	std::shared_ptr<const MeshGeometry> result;
+	if (loaded->Load(path, flags)) {
+		result = std::move(loaded);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (result) {
+			geometry[key] = result;
+		}
+		loading.erase(key);
+	}
+	promise.set_value(result);
+	return result;
+}
+
+size_t GeometryCache::Trim() {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t dropped = 0;
+	for (auto it = geometry.begin(); it != geometry.end();) {
+		if (it->second.expired()) {
+			it = geometry.erase(it);
+			++dropped;
+		} else {
+			++it;
+		}
+	}
+	return dropped;
+}
+
+void GeometryCache::Clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	geometry.clear();
+}
+
+size_t GeometryCache::Size() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return geometry.size();
+}
@@ -0,0 +1,58 @@
+// GeometryCache.h
+#pragma once
+
+#include "Mesh.h"
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <future>
+#include <unordered_map>
+#include <filesystem>
+
+// Shared, immutable mesh geometry keyed by the file it comes from: the one
+// MeshGeometry::Load actually reads (a current .gwmesh, else the source),
+// by canonical path, size and write time, plus the load flags. Every load
+// with the same key returns the same MeshGeometry, so N instances of a
+// prop cost one load and one copy of the vertex data, and a file changed
+// on disk is loaded afresh. The cache only holds weak references: geometry
+// goes away with the last mesh that uses it.
+class GeometryCache {
+public:
+	// Returns the cached geometry for `path`, loading it on a miss.
+	// Null if the file cannot be read or parsed. Safe to call from any thread;
+	// concurrent calls for the same file share a single load.
+	static std::shared_ptr<const MeshGeometry> Load(const std::string& path, uint32_t flags = MeshLoad_Default);
+
+	// Forgets entries whose geometry is already gone.
+	static size_t Trim();
+	static void   Clear();
+	static size_t Size();
+
+private:
+	struct FileKey {
+		std::string path;        // canonical
+		uintmax_t   size      = 0;
+		int64_t     writeTime = 0;
+		uint32_t    flags     = 0;
+		bool operator==(const FileKey& o) const {
+			return path == o.path && size == o.size && writeTime == o.writeTime && flags == o.flags;
+		}
+	};
+
+	struct FileKeyHash {
+		size_t operator()(const FileKey& k) const {
+			uint64_t h = std::hash<std::string>()(k.path);
+			h ^= (uint64_t(k.size) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2));
+			h ^= (uint64_t(k.writeTime) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2));
+			h ^= uint64_t(k.flags) * 0x9E3779B97F4A7C15ull;
+			return size_t(h);
+		}
+	};
+
+	static std::mutex                                                              mutex;
+	static std::unordered_map<FileKey, std::weak_ptr<const MeshGeometry>, FileKeyHash> geometry;
+	// loads in progress, so concurrent requests for the same file wait for one load
+	static std::unordered_map<FileKey, std::shared_future<std::shared_ptr<const MeshGeometry>>, FileKeyHash> loading;
+};
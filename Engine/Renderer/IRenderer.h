@@ -4,27 +4,107 @@
 #include "vector"
 #include "memory"
 #include "Mesh.h"
+#include "DebugDraw.h"
+#include "TextureFormat.h"
+#include "DynamicResolution.h"
 #include "../Core/Runtime.h"
 
 namespace Renderer {
 	struct ImageData {
 		std::vector<unsigned char> pixels;
-		int width, height;
+		int width  = 0;
+		int height = 0;
 	};
+
+	// Where the OpenGL renderer draws. Headless renders into an offscreen
+	// target at whatever size setSize asks for and needs no display. Hosted
+	// draws inside someone else's context (the editor's SDL renderer), into
+	// a texture the host then draws itself; see RendererGL21::AttachHost.
+	enum class GLOutput { Window, Headless, Hosted };
+
+	// What the last RenderFrame drew at each LOD level.
+	struct LodStats {
+		uint32_t meshes[MaxMeshLods]    = {};
+		uint32_t triangles[MaxMeshLods] = {};
+		uint32_t fullTriangles          = 0;   // the same meshes at LOD 0
+
+		void Record(size_t level, const MeshGeometry& mesh) {
+			meshes[level]    += 1;
+			triangles[level] += static_cast<uint32_t>(mesh.LodIndices(level).size() / 3);
+			fullTriangles    += static_cast<uint32_t>(mesh.indices.size() / 3);
+		}
+	};
+
+	// CPU-side cost of the last RenderFrame.
+	struct FrameStats {
+		float    cpuMs     = 0.0f;   // RenderFrame start to Present/SwapBuffers
+		uint32_t drawCalls = 0;      // mesh draws only, not skybox or gizmos
+		uint32_t triangles = 0;
+		uint32_t meshesTested = 0;   // frustum culling; 0 when the renderer doesn't cull
+		uint32_t meshesCulled = 0;
+		uint32_t stateChanges = 0;            // vertex/index buffer binds issued
+		uint32_t redundantStateChanges = 0;   // binds skipped, buffers already bound
+		float    readbackStallMs = 0.0f;      // CaptureFrame waiting on the GPU, see GLFrameReadback
+		uint32_t debugDrawCalls  = 0;         // DebugDrawList draws, gizmos included
+		uint32_t debugVertices   = 0;
+		float    resolutionScale = 1.0f;      // the scene's render scale, see DynamicResolution
+		float    sceneGpuMs      = 0.0f;      // newest scene pass GPU time; 0 while dynamic resolution is off
+	};
+
+	// Screen-space error (pixels) a LOD may introduce at a bias of 0.
+	constexpr float LodPixelError = 1.0f;
 	
 	class IRenderer {
 	public:
 		virtual bool Init(Camera *cam, Runtime::Runtime *runtime) = 0;
+		// Window messages and input; runs on the thread that created the
+		// window. Returns false once the window has been asked to close.
+		virtual bool ProcessEvents() { return true; }
+		// Draws and presents. May run on a render thread, see MakeCurrent.
 		virtual void RenderFrame() = 0;
+		// Binds (or releases) the API context to the calling thread so
+		// RenderFrame can move to a dedicated thread. Returns false when the
+		// backend can't hand its context over.
+		virtual bool MakeCurrent(bool current) { return false; }
 		virtual ~IRenderer() = default;
 		virtual bool SetMeshes(std::vector<std::shared_ptr<Mesh>> msh) = 0;
 		virtual bool UpdateMesh(int indx, std::shared_ptr<Mesh> msh) = 0;
 		virtual bool DeleteMesh(int indx) = 0;
 		virtual int AddMesh(std::shared_ptr<Mesh> mesh) = 0;
+		// Moves the mesh in slot `indx` without touching its buffers.
+		virtual bool UpdateTransform(int indx, const Transform& transform) = 0;
+		// Re-uploads vertices [first, first + count) after the caller changed
+		// them in place. Only for geometry the caller owns: GeometryCache hands
+		// out shared geometry that must stay immutable.
+		virtual bool UpdateGeometryRange(int indx, size_t first, size_t count) = 0;
 	
-		virtual ImageData CaptureFrame() = 0;
+		// The newest finished frame, top row first. The storage is reused:
+		// the reference stays valid until the next call.
+		virtual const ImageData& CaptureFrame() = 0;
 		virtual void setSize(int newWidth, int newHeight) = 0;
+
+		// GPU textures for TextureManager, called on the thread that renders.
+		// CreateTexture returns an API object for a mip chain of `mipCount`
+		// levels, or 0 (also when `format` can't be sampled; RGBA8 always
+		// can). Levels then arrive one at a time, `size` bytes each.
+		virtual uintptr_t CreateTexture(int width, int height, int mipCount, PixelFormat format) { return 0; }
+		virtual bool UploadTextureLevel(uintptr_t texture, int level, int width, int height, const uint8_t* data, size_t size) { return false; }
+		virtual void DeleteTexture(uintptr_t texture) {}
 		
 		Camera *cam;
+
+		// each +1 doubles the error allowed before switching to a finer LOD
+		float    lodBias = 0.0f;
+		// order draws by RenderQueue key instead of slot order
+		bool     sortDraws = true;
+		// this frame's debug primitives, replaced before every RenderFrame;
+		// the renderer may add its own (editor gizmos) before drawing it
+		DebugDrawList debugDraw;
+		LodStats lodStats;
+		FrameStats frameStats;
+		// scene render scale bounds and budget; a renderer without an
+		// offscreen scene pass ignores it and stays at full scale
+		DynamicResolutionSettings dynamicResolution;
+		DynamicResolution         resolutionController;
 	};
 }
\ No newline at end of file
@@ -1,65 +1,455 @@
 #include "Mesh.h"
-#include <fstream>
-#include <sstream>
+#include "ObjParser.h"
+#include "MeshFormat.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexPacking.h"
+#include "../Core/MappedFile.h"
+#include "../Core/Logger.h"
 #include <iostream>
-#include <algorithm>   // for std::replace
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <limits>
+
+MeshGeometry::MeshGeometry(std::vector<Vertex> verts, std::vector<uint32_t> inds)
+  : vertices(std::move(verts)), indices(std::move(inds))
+{
+	ComputeBounds();
+}
 
 Mesh::Mesh(const std::vector<Vertex>& verts,
 		   const std::vector<uint32_t>& inds)
-  : vertices(verts), indices(inds)
-{}
+  : geometry(std::make_shared<MeshGeometry>(verts, inds))
+{
+}
 
-bool Mesh::LoadFromOBJ(const std::string& path) {
-	std::ifstream file(path);
-	if (!file.is_open()) {
-		std::cerr << "Failed to open OBJ file: " << path << "\n";
+namespace {
+	// Whole triangles, each index naming one of `vertexCount` vertices.
+	bool TrianglesValid(const std::vector<uint32_t>& indices, size_t vertexCount) {
+		if (indices.size() % 3 != 0) {
+			return false;
+		}
+		for (uint32_t index : indices) {
+			if (index >= vertexCount) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Open-addressing table from a (position, texcoord, normal) index triplet
+	// to the welded vertex it produced. Keys live in `corners`, the table only
+	// stores vertex indices.
+	class CornerWelder {
+	public:
+		explicit CornerWelder(size_t expected) {
+			size_t capacity = 16;
+			while (capacity < expected * 2) capacity <<= 1;
+			slots.assign(capacity, Empty);
+			mask = capacity - 1;
+			corners.reserve(expected);
+		}
+
+		// returns the welded index and whether the corner was seen before
+		uint32_t Insert(const ObjParser::Corner& c, bool& inserted) {
+			size_t slot = Hash(c) & mask;
+			while (slots[slot] != Empty) {
+				const ObjParser::Corner& k = corners[slots[slot]];
+				if (k.position == c.position && k.texcoord == c.texcoord && k.normal == c.normal) {
+					inserted = false;
+					return slots[slot];
+				}
+				slot = (slot + 1) & mask;
+			}
+			uint32_t index = static_cast<uint32_t>(corners.size());
+			slots[slot] = index;
+			corners.push_back(c);
+			inserted = true;
+			return index;
+		}
+
+	private:
+		static constexpr uint32_t Empty = std::numeric_limits<uint32_t>::max();
+
+		static size_t Hash(const ObjParser::Corner& c) {
+			uint64_t h = uint32_t(c.position) * 0x9E3779B97F4A7C15ull;
+			h ^= (uint32_t(c.texcoord) + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+			h ^= (uint32_t(c.normal) + 0x85EBCA77C2B2AE63ull) * 0x165667B19E3779F9ull;
+			return static_cast<size_t>(h ^ (h >> 29));
+		}
+
+		std::vector<uint32_t>          slots;
+		std::vector<ObjParser::Corner> corners;
+		size_t                         mask = 0;
+	};
+}
+
+bool MeshGeometry::LoadFromOBJ(const std::string& path, uint32_t flags) {
+	ObjParser::ObjData obj;
+	if (!ObjParser::ParseFile(path, obj)) {
 		return false;
 	}
 
-	std::vector<glm::vec3> tempPositions;
-	std::vector<glm::vec2> tempTexCoords;
-	std::vector<glm::vec3> tempNormals;
+	vertices.clear();
+	indices.clear();
+	indices.reserve(obj.corners.size());
 
-	std::string line;
-	while (std::getline(file, line)) {
-		std::istringstream iss(line);
-		std::string type;
-		iss >> type;
-		if (type == "v") {
-			glm::vec3 pos; iss >> pos.x >> pos.y >> pos.z;
-			tempPositions.push_back(pos);
+	// weld identical corners into one vertex and index them
+	CornerWelder welder(obj.corners.size());
+	for (const ObjParser::Corner& c : obj.corners) {
+		bool inserted = false;
+		uint32_t index = welder.Insert(c, inserted);
+		if (inserted) {
+			Vertex vert{};
+			vert.position = obj.positions[c.position];
+			if (c.texcoord >= 0) vert.texcoord = obj.texcoords[c.texcoord];
+			if (c.normal >= 0)   vert.normal   = obj.normals[c.normal];
+			vertices.push_back(vert);
 		}
-		else if (type == "vt") {
-			glm::vec2 uv; iss >> uv.x >> uv.y;
-			tempTexCoords.push_back(uv);
+		indices.push_back(index);
+	}
+	vertices.shrink_to_fit();
+	packed.clear();
+	ComputeBounds();
+	lods.clear();
+	processed = MeshLoad_Default;
+
+	float weldRatio = indices.empty() ? 1.0f : float(indices.size()) / float(vertices.size());
+	std::cout << "Loaded OBJ: " << path
+			  << " (" << vertices.size() << " verts, " << indices.size() << " indices, "
+			  << "weld ratio " << weldRatio << ":1)\n";
+
+	ApplyLoadFlags(flags);
+	
+	return true;
+}
+
+
+void MeshGeometry::ComputeBounds() {
+	if (IsPacked()) {
+		// packed positions are defined relative to the bounds
+		return;
+	}
+	if (vertices.empty()) {
+		boundsMin = boundsMax = glm::vec3(0.0f);
+		return;
+	}
+	boundsMin = boundsMax = vertices[0].position;
+	for (const Vertex& v : vertices) {
+		boundsMin = glm::min(boundsMin, v.position);
+		boundsMax = glm::max(boundsMax, v.position);
+	}
+}
+
+void MeshGeometry::ApplyLoadFlags(uint32_t flags) {
+	uint32_t missing = flags & ~processed;
+	// the reordering and simplification passes work on full vertices
+	if ((missing & (MeshLoad_Lods | MeshLoad_Optimize)) && IsPacked()) {
+		Unpack();
+	}
+	if (missing & MeshLoad_Lods) {
+		MeshSimplifier::GenerateLods(*this);
+		// an already optimized mesh only needs the new levels reordered
+		if (processed & MeshLoad_Optimize) {
+			for (MeshLod& lod : lods) {
+				MeshOptimizer::OptimizeVertexCache(lod.indices, vertices.size());
+			}
 		}
-		else if (type == "vn") {
-			glm::vec3 n; iss >> n.x >> n.y >> n.z;
-			tempNormals.push_back(n);
+	}
+	if (missing & MeshLoad_Optimize) {
+		MeshOptimizer::Optimize(*this);
+	}
+	processed |= flags & ~uint32_t(MeshLoad_Pack);
+	if ((flags & MeshLoad_Pack) && !IsPacked()) {
+		Pack();
+	}
+}
+
+glm::vec3 MeshGeometry::Position(uint32_t i) const {
+	if (!IsPacked()) return vertices[i].position;
+	return VertexPacking::DequantizePosition(packed[i].position, VertexPacking::QuantizationFor(boundsMin, boundsMax));
+}
+
+glm::vec3 MeshGeometry::Normal(uint32_t i) const {
+	if (!IsPacked()) return vertices[i].normal;
+	return VertexPacking::OctDecode(packed[i].normal);
+}
+
+glm::vec2 MeshGeometry::Texcoord(uint32_t i) const {
+	if (!IsPacked()) return vertices[i].texcoord;
+	return glm::vec2(VertexPacking::HalfToFloat(packed[i].texcoord[0]), VertexPacking::HalfToFloat(packed[i].texcoord[1]));
+}
+
+glm::vec3 MeshGeometry::DequantizeOffset() const {
+	return VertexPacking::QuantizationFor(boundsMin, boundsMax).offset;
+}
+
+glm::vec3 MeshGeometry::DequantizeScale() const {
+	return VertexPacking::QuantizationFor(boundsMin, boundsMax).scale;
+}
+
+glm::mat4 MeshGeometry::DequantizeMatrix() const {
+	VertexPacking::Quantization q = VertexPacking::QuantizationFor(boundsMin, boundsMax);
+	return glm::scale(glm::translate(glm::mat4(1.0f), q.offset), q.scale);
+}
+
+void MeshGeometry::Pack() {
+	// the quantization grid comes from the bounds, which stay fixed from here on
+	VertexPacking::Quantization q = VertexPacking::QuantizationFor(boundsMin, boundsMax);
+	packed.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		const Vertex& v = vertices[i];
+		PackedVertex& p = packed[i];
+		VertexPacking::QuantizePosition(v.position, q, p.position);
+		VertexPacking::OctEncode(v.normal, p.normal);
+		p.texcoord[0] = VertexPacking::FloatToHalf(v.texcoord.x);
+		p.texcoord[1] = VertexPacking::FloatToHalf(v.texcoord.y);
+	}
+	std::vector<Vertex>().swap(vertices);
+	processed |= MeshLoad_Pack;
+}
+
+void MeshGeometry::Unpack() {
+	vertices.resize(packed.size());
+	for (uint32_t i = 0; i < packed.size(); ++i) {
+		vertices[i].position = Position(i);
+		vertices[i].normal   = Normal(i);
+		vertices[i].texcoord = Texcoord(i);
+	}
+	std::vector<PackedVertex>().swap(packed);
+	processed &= ~uint32_t(MeshLoad_Pack);
+}
+
+float MeshGeometry::BoundingRadius() const {
+	return glm::length(glm::max(glm::abs(boundsMin), glm::abs(boundsMax)));
+}
+
+size_t Mesh::SelectLod(const glm::vec3& viewPos, float pixelScale, float maxPixelError) const {
+	if (!geometry || geometry->lods.empty()) {
+		return 0;
+	}
+	float distance = glm::length(viewPos - transform.position) - geometry->BoundingRadius();
+	if (distance <= 0.0f) {
+		return 0;
+	}
+	float pixelsPerUnit = pixelScale / distance;
+	for (size_t level = geometry->LodCount() - 1; level > 0; --level) {
+		if (geometry->LodError(level) * pixelsPerUnit <= maxPixelError) {
+			return level;
 		}
-		else if (type == "f") {
-			for (int i = 0; i < 3; ++i) {
-				std::string token; iss >> token;
-				std::replace(token.begin(), token.end(), '/', ' ');
-				std::istringstream tok(token);
-				int vi, ti, ni;
-				tok >> vi >> ti >> ni;
-
-				Vertex vert{};
-				vert.position = tempPositions[vi - 1];
-				vert.texcoord = tempTexCoords[ti - 1];
-				vert.normal   = tempNormals[ni - 1];
-
-				vertices.push_back(vert);
-				indices.push_back(static_cast<uint32_t>(indices.size()));
+	}
+	return 0;
+}
+
+std::string MeshGeometry::CookedPathFor(const std::string& sourcePath) {
+	return std::filesystem::path(sourcePath).replace_extension(MeshFormat::Extension).string();
+}
+
+std::string MeshGeometry::FileToLoad(const std::string& path) {
+	namespace fs = std::filesystem;
+
+	if (fs::path(path).extension() == MeshFormat::Extension) {
+		return path;
+	}
+
+	// a stale cook (source edited after cooking) is passed over
+	std::error_code ec;
+	std::string cooked = CookedPathFor(path);
+	auto cookedTime = fs::last_write_time(cooked, ec);
+	if (!ec) {
+		auto sourceTime = fs::last_write_time(path, ec);
+		if (ec || cookedTime >= sourceTime) {
+			return cooked;
+		}
+	}
+	return path;
+}
+
+bool MeshGeometry::Load(const std::string& path, uint32_t flags) {
+	std::string file = FileToLoad(path);
+	if (file != path) {
+		// a cook we can't read falls through to the OBJ
+		if (LoadFromCooked(file, flags)) {
+			return true;
+		}
+	} else if (std::filesystem::path(path).extension() == MeshFormat::Extension) {
+		return LoadFromCooked(path, flags);
+	}
+
+	return LoadFromOBJ(path, flags);
+}
+
+bool MeshGeometry::LoadFromCooked(const std::string& path, uint32_t flags) {
+	using MeshFormat::MeshFileHeader;
+
+	MappedFile file;
+	if (!file.Open(path)) {
+		Logger::Error("Failed to open cooked mesh: " + path);
+		return false;
+	}
+
+	if (file.Size() < sizeof(MeshFileHeader)) {
+		Logger::Error("Cooked mesh is truncated: " + path);
+		return false;
+	}
+
+	MeshFileHeader header;
+	memcpy(&header, file.Data(), sizeof(header));
+
+	bool packedFile = (header.flags & MeshLoad_Pack) != 0;
+	size_t vertexStride = packedFile ? sizeof(PackedVertex) : sizeof(Vertex);
+	if (memcmp(header.magic, MeshFormat::Magic, 4) != 0
+		|| header.version != MeshFormat::Version
+		|| header.vertexStride != vertexStride) {
+		Logger::Warn("Cooked mesh has an old or foreign format, ignoring: " + path);
+		return false;
+	}
+
+	uint64_t vertexBytes = uint64_t(header.vertexCount) * vertexStride;
+	uint64_t indexBytes  = uint64_t(header.indexCount) * sizeof(uint32_t);
+	if (header.vertexOffset + vertexBytes > file.Size()
+		|| header.indexOffset + indexBytes > file.Size()) {
+		Logger::Error("Cooked mesh payload is out of range: " + path);
+		return false;
+	}
+
+	uint64_t lodTableBytes = uint64_t(header.lodCount) * sizeof(MeshFormat::MeshLodEntry);
+	if (header.lodCount >= MaxMeshLods || header.lodOffset + lodTableBytes > file.Size()) {
+		Logger::Error("Cooked mesh LOD table is out of range: " + path);
+		return false;
+	}
+
+	std::vector<MeshFormat::MeshLodEntry> lodTable(header.lodCount);
+	if (!lodTable.empty()) {
+		memcpy(lodTable.data(), file.Data() + header.lodOffset, lodTableBytes);
+	}
+	for (const MeshFormat::MeshLodEntry& entry : lodTable) {
+		if (entry.indexOffset + uint64_t(entry.indexCount) * sizeof(uint32_t) > file.Size()) {
+			Logger::Error("Cooked mesh LOD payload is out of range: " + path);
+			return false;
+		}
+	}
+
+	// indices go straight to the draw calls and to picking, so every one has
+	// to name a vertex before anything of ours is replaced
+	std::vector<uint32_t> fileIndices(header.indexCount);
+	memcpy(fileIndices.data(), file.Data() + header.indexOffset, indexBytes);
+	std::vector<MeshLod> fileLods(lodTable.size());
+	for (size_t i = 0; i < lodTable.size(); ++i) {
+		fileLods[i].indices.resize(lodTable[i].indexCount);
+		fileLods[i].error = lodTable[i].error;
+		memcpy(fileLods[i].indices.data(), file.Data() + lodTable[i].indexOffset, lodTable[i].indexCount * sizeof(uint32_t));
+	}
+	if (!TrianglesValid(fileIndices, header.vertexCount)) {
+		Logger::Error("Cooked mesh has invalid indices: " + path);
+		return false;
+	}
+	for (const MeshLod& lod : fileLods) {
+		if (!TrianglesValid(lod.indices, header.vertexCount)) {
+			Logger::Error("Cooked mesh has invalid LOD indices: " + path);
+			return false;
+		}
+	}
+
+	if (packedFile) {
+		vertices.clear();
+		packed.resize(header.vertexCount);
+		memcpy(packed.data(), file.Data() + header.vertexOffset, vertexBytes);
+	} else {
+		packed.clear();
+		vertices.resize(header.vertexCount);
+		memcpy(vertices.data(), file.Data() + header.vertexOffset, vertexBytes);
+	}
+	indices = std::move(fileIndices);
+	lods    = std::move(fileLods);
+
+	boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	processed = header.flags;
+
+	std::cout << "Loaded cooked mesh: " << path
+			  << " (" << VertexCount() << (IsPacked() ? " packed" : "") << " verts, " << indices.size() << " indices, "
+			  << LodCount() << " LODs)\n";
+
+	ApplyLoadFlags(flags);
+
+	return true;
+}
+
+bool MeshGeometry::SaveCooked(const std::string& path, uint64_t sourceSize) const {
+	using MeshFormat::MeshFileHeader;
+
+	MeshFileHeader header{};
+	memcpy(header.magic, MeshFormat::Magic, 4);
+	header.version      = MeshFormat::Version;
+	const char* vertexData  = IsPacked() ? reinterpret_cast<const char*>(packed.data()) : reinterpret_cast<const char*>(vertices.data());
+	size_t      vertexBytes = IsPacked() ? packed.size() * sizeof(PackedVertex) : vertices.size() * sizeof(Vertex);
+
+	header.vertexStride = IsPacked() ? sizeof(PackedVertex) : sizeof(Vertex);
+	header.vertexCount  = static_cast<uint32_t>(VertexCount());
+	header.indexCount   = static_cast<uint32_t>(indices.size());
+	header.vertexOffset = static_cast<uint32_t>(MeshFormat::AlignUp(sizeof(MeshFileHeader)));
+	header.indexOffset  = static_cast<uint32_t>(MeshFormat::AlignUp(header.vertexOffset + vertexBytes));
+	for (int i = 0; i < 3; ++i) {
+		header.boundsMin[i] = boundsMin[i];
+		header.boundsMax[i] = boundsMax[i];
+	}
+	header.flags      = processed;
+	header.sourceSize = sourceSize;
+	header.lodCount   = static_cast<uint32_t>(lods.size());
+	header.lodOffset  = lods.empty() ? 0 : static_cast<uint32_t>(MeshFormat::AlignUp(header.indexOffset + indices.size() * sizeof(uint32_t)));
+
+	std::vector<MeshFormat::MeshLodEntry> lodTable(lods.size());
+	uint64_t offset = MeshFormat::AlignUp(header.lodOffset + lodTable.size() * sizeof(MeshFormat::MeshLodEntry));
+	for (size_t i = 0; i < lods.size(); ++i) {
+		lodTable[i].indexOffset = static_cast<uint32_t>(offset);
+		lodTable[i].indexCount  = static_cast<uint32_t>(lods[i].indices.size());
+		lodTable[i].error       = lods[i].error;
+		offset = MeshFormat::AlignUp(offset + lods[i].indices.size() * sizeof(uint32_t));
+	}
+
+	// write next to the target and rename, so a crashed cook never leaves a
+	// half-written file that looks newer than its source
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			Logger::Error("Failed to write cooked mesh: " + path);
+			return false;
+		}
+
+		const char padding[MeshFormat::Alignment] = {};
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(padding, header.vertexOffset - sizeof(header));
+		out.write(vertexData, vertexBytes);
+		out.write(padding, header.indexOffset - (header.vertexOffset + vertexBytes));
+		out.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+
+		if (!lods.empty()) {
+			uint64_t written = header.indexOffset + indices.size() * sizeof(uint32_t);
+			out.write(padding, header.lodOffset - written);
+			out.write(reinterpret_cast<const char*>(lodTable.data()), lodTable.size() * sizeof(MeshFormat::MeshLodEntry));
+			written = header.lodOffset + lodTable.size() * sizeof(MeshFormat::MeshLodEntry);
+			for (size_t i = 0; i < lods.size(); ++i) {
+				out.write(padding, lodTable[i].indexOffset - written);
+				out.write(reinterpret_cast<const char*>(lods[i].indices.data()), lods[i].indices.size() * sizeof(uint32_t));
+				written = lodTable[i].indexOffset + lods[i].indices.size() * sizeof(uint32_t);
 			}
 		}
+
+		if (!out) {
+			Logger::Error("Failed to write cooked mesh: " + path);
+			return false;
+		}
 	}
 
-	std::cout << "Loaded OBJ: " << path
-			  << " (" << vertices.size() << " verts)\n";
-	
-	transform = *new Transform();
-	
+	std::error_code ec;
+	std::filesystem::rename(tempPath, path, ec);
+	if (ec) {
+		Logger::Error("Failed to replace cooked mesh " + path + ": " + ec.message());
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
 	return true;
 }
@@ -3,6 +3,7 @@
 #include "Core/Transform.h"
 #include <vector>
 #include <string>
+#include <memory>
 #include <cstdint>
 #include <glm/glm.hpp>
 
@@ -12,17 +13,118 @@ struct Vertex {
 	glm::vec2 texcoord;
 };
 
+// 12-byte alternative to Vertex (32 bytes), see VertexPacking.h.
+struct PackedVertex {
+	int16_t  position[3];   // snorm16 within the mesh bounds
+	int8_t   normal[2];     // octahedral snorm8
+	uint16_t texcoord[2];   // half floats
+};
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex layout changed");
+
+// Optional processing applied while loading. Cooked files record which steps
+// they already went through, so only the missing ones run at load time.
+enum MeshLoadFlags : uint32_t {
+	MeshLoad_Default  = 0,
+	MeshLoad_Optimize = 1u << 0,   // vertex cache, overdraw and fetch reordering (MeshOptimizer)
+	MeshLoad_Lods     = 1u << 1,   // simplified LOD chain (MeshSimplifier)
+	MeshLoad_Pack     = 1u << 2,   // keep vertices as PackedVertex, `vertices` is left empty
+};
+
+// LOD 0 is the mesh itself; at most this many levels in total.
+constexpr size_t MaxMeshLods = 4;
+
+// A coarser index list over the same vertices.
+struct MeshLod {
+	std::vector<uint32_t> indices;
+	float                 error = 0.0f;   // object-space deviation from LOD 0
+};
+
+// Vertex/index data loaded from one asset. Once loaded it is treated as
+// immutable and shared between every Mesh placed from the same file (see
+// GeometryCache), so nothing per-instance lives here.
+class MeshGeometry {
+public:
+	MeshGeometry() = default;
+	// takes the buffers by value so callers can move them in
+	MeshGeometry(std::vector<Vertex> verts, std::vector<uint32_t> inds);
+
+	std::vector<Vertex>      vertices;
+	std::vector<PackedVertex> packed;   // used instead of `vertices` once packed
+	std::vector<uint32_t>    indices;
+
+	// local-space bounds, filled by every load path
+	glm::vec3                boundsMin = glm::vec3(0.0f);
+	glm::vec3                boundsMax = glm::vec3(0.0f);
+
+	// levels 1.. of the LOD chain, each coarser than the last
+	std::vector<MeshLod>     lods;
+
+	// MeshLoadFlags steps that have already been applied to this data
+	uint32_t                 processed = MeshLoad_Default;
+
+	// Loads `path`, preferring its cooked .gwmesh sibling when that is newer.
+	bool Load(const std::string& path, uint32_t flags = MeshLoad_Default);
+	bool LoadFromOBJ(const std::string& path, uint32_t flags = MeshLoad_Default);
+	bool LoadFromCooked(const std::string& path, uint32_t flags = MeshLoad_Default);
+	bool SaveCooked(const std::string& path, uint64_t sourceSize = 0) const;
+
+	void ComputeBounds();
+
+	// Layout-independent vertex access, decoding packed vertices on the fly.
+	bool      IsPacked() const { return !packed.empty(); }
+	size_t    VertexCount() const { return IsPacked() ? packed.size() : vertices.size(); }
+	glm::vec3 Position(uint32_t i) const;
+	glm::vec3 Normal(uint32_t i) const;
+	glm::vec2 Texcoord(uint32_t i) const;
+
+	// Packed positions decode as offset + q * scale; DequantizeMatrix() is that
+	// as a matrix, for folding into the model matrix at draw time.
+	glm::vec3 DequantizeOffset() const;
+	glm::vec3 DequantizeScale() const;
+	glm::mat4 DequantizeMatrix() const;
+
+	void Pack();
+	void Unpack();
+
+	size_t LodCount() const { return 1 + lods.size(); }
+	const std::vector<uint32_t>& LodIndices(size_t level) const { return level == 0 ? indices : lods[level - 1].indices; }
+	float LodError(size_t level) const { return level == 0 ? 0.0f : lods[level - 1].error; }
+
+	// Radius around the mesh origin that contains the bounds, whatever the rotation.
+	float BoundingRadius() const;
+
+	// Runs the steps in `flags` that are not in `processed` yet.
+	void ApplyLoadFlags(uint32_t flags);
+
+	// "assets/models/test.obj" -> "assets/models/test.gwmesh"
+	static std::string CookedPathFor(const std::string& sourcePath);
+	// The file Load reads for `path`: its cooked sibling when that is at
+	// least as new, otherwise `path` itself.
+	static std::string FileToLoad(const std::string& path);
+};
+
+class Texture;
+
+// One placed instance of some geometry: the per-entity state plus a shared
+// reference to the data it draws.
 class Mesh {
 public:
-	// two-arg constructor so emplace_back in Model.cpp works
 	Mesh() = default;
+	explicit Mesh(std::shared_ptr<const MeshGeometry> geo) : geometry(std::move(geo)) {}
+	// two-arg constructor so emplace_back in Model.cpp works
 	Mesh(const std::vector<Vertex>& verts,
 		 const std::vector<uint32_t>& inds);
 
-	std::vector<Vertex>      vertices;
-	std::vector<uint32_t>    indices;
+	std::shared_ptr<const MeshGeometry> geometry;
 	Transform                transform;
 	bool                     is_castable = true;
+	// Never moves at runtime: renderers merge it into a StaticBatcher cell.
+	// They re-sync every frame, so moving one only re-merges its cells.
+	bool                     is_static = false;
+	// Diffuse texture from TextureManager; drawn untextured until it's Ready.
+	std::shared_ptr<Texture> texture;
 
-	bool LoadFromOBJ(const std::string& path);
+	// Coarsest level whose error projects to at most `maxPixelError` pixels
+	// when seen from `viewPos`. `pixelScale` is viewport height / (2 tan(fovY / 2)).
+	size_t SelectLod(const glm::vec3& viewPos, float pixelScale, float maxPixelError) const;
 };
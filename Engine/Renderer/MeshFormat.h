@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout of a cooked .gwmesh file (little endian):
+//
+//   MeshFileHeader                      (80 bytes)
+//   Vertex   vertices[vertexCount]      at vertexOffset  (PackedVertex when flags has MeshLoad_Pack)
+//   uint32_t indices[indexCount]        at indexOffset   (LOD 0)
+//   MeshLodEntry lods[lodCount]         at lodOffset     (levels 1..)
+//   uint32_t lod indices                at each entry's indexOffset
+//
+// Payload sections start on 16-byte boundaries and hold exactly the in-memory
+// Vertex/index data, so loading is a map plus two copies with no parsing.
+namespace MeshFormat {
+	constexpr char     Magic[4]   = { 'G', 'W', 'M', 'S' };
+	constexpr uint32_t Version    = 2;
+	constexpr uint32_t Alignment  = 16;
+	constexpr const char* Extension = ".gwmesh";
+
+	struct MeshFileHeader {
+		char     magic[4];
+		uint32_t version;
+		uint32_t vertexStride;   // sizeof(Vertex) or sizeof(PackedVertex), checked on load
+		uint32_t flags;          // MeshLoadFlags already applied to the payload
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t vertexOffset;   // byte offsets from the start of the file
+		uint32_t indexOffset;
+		float    boundsMin[3];
+		float    boundsMax[3];
+		uint64_t sourceSize;     // size of the OBJ this was cooked from
+		uint32_t lodCount;       // levels after LOD 0
+		uint32_t lodOffset;
+		uint32_t reserved[2];
+	};
+	static_assert(sizeof(MeshFileHeader) == 80, "MeshFileHeader layout changed");
+
+	struct MeshLodEntry {
+		uint32_t indexOffset;
+		uint32_t indexCount;
+		float    error;
+		uint32_t reserved;
+	};
+	static_assert(sizeof(MeshLodEntry) == 16, "MeshLodEntry layout changed");
+
+	inline uint64_t AlignUp(uint64_t value) {
+		return (value + Alignment - 1) & ~uint64_t(Alignment - 1);
+	}
+}
@@ -0,0 +1,292 @@
+#include "MeshOptimizer.h"
+#include "../Core/Logger.h"
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cstdio>
+
+namespace {
+	// FIFO cache simulated with timestamps: a vertex is resident while fewer
+	// than `cacheSize` misses happened since it was last loaded. Bumping
+	// `time` by cacheSize + 1 flushes the whole cache.
+	struct FifoCache {
+		std::vector<uint32_t> stamps;
+		uint32_t              time;
+		unsigned              size;
+
+		FifoCache(size_t vertexCount, unsigned cacheSize)
+			: stamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+		unsigned Touch(uint32_t v) {
+			if (time - stamps[v] > size) {
+				stamps[v] = time++;
+				return 1;
+			}
+			return 0;
+		}
+
+		unsigned TouchTriangle(const uint32_t* tri) {
+			return Touch(tri[0]) + Touch(tri[1]) + Touch(tri[2]);
+		}
+
+		void Flush() { time += size + 1; }
+	};
+
+	std::string Fixed(float value) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%.3f", value);
+		return buf;
+	}
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize) {
+	CacheStats stats;
+	if (indices.size() < 3) {
+		return stats;
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint8_t> referenced(vertexCount, 0);
+	size_t misses = 0, unique = 0;
+	for (uint32_t v : indices) {
+		misses += cache.Touch(v);
+		if (!referenced[v]) {
+			referenced[v] = 1;
+			++unique;
+		}
+	}
+
+	stats.acmr = float(misses) / float(indices.size() / 3);
+	stats.atvr = float(misses) / float(unique);
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize, std::vector<uint32_t>* clusters) {
+	const size_t triangleCount = indices.size() / 3;
+	if (clusters) {
+		clusters->assign(1, 0);
+	}
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// vertex -> triangle adjacency (CSR) and live triangle counts
+	std::vector<uint32_t> live(vertexCount, 0);
+	for (uint32_t v : indices) ++live[v];
+
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + live[v];
+
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<uint8_t>  emitted(triangleCount, 0);
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> out;
+	deadEnd.reserve(indices.size());
+	out.reserve(indices.size());
+
+	uint32_t time   = cacheSize + 1;
+	uint32_t cursor = 0;
+	int64_t  fanning = indices[0];
+
+	while (fanning >= 0) {
+		// emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (uint32_t k = offsets[fanning]; k < offsets[fanning + 1]; ++k) {
+			uint32_t t = adjacency[k];
+			if (emitted[t]) continue;
+			emitted[t] = 1;
+
+			for (int c = 0; c < 3; ++c) {
+				uint32_t v = indices[t * 3 + c];
+				out.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+				if (time - cacheTime[v] > cacheSize) {
+					cacheTime[v] = time++;
+				}
+			}
+		}
+
+		// next fanning vertex: the one still in cache that will stay there
+		// longest once its remaining triangles are emitted
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t v : candidates) {
+			if (live[v] == 0) continue;
+			int64_t priority = 0;
+			if (int64_t(time - cacheTime[v]) + 2 * int64_t(live[v]) <= int64_t(cacheSize)) {
+				priority = time - cacheTime[v];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = v;
+			}
+		}
+
+		if (best < 0) {
+			// dead end: back up through recently used vertices, then scan
+			while (!deadEnd.empty() && best < 0) {
+				uint32_t v = deadEnd.back();
+				deadEnd.pop_back();
+				if (live[v] > 0) best = v;
+			}
+			while (best < 0 && cursor < vertexCount) {
+				if (live[cursor] > 0) best = cursor;
+				else ++cursor;
+			}
+			if (best >= 0 && clusters) {
+				clusters->push_back(static_cast<uint32_t>(out.size() / 3));
+			}
+		}
+		fanning = best;
+	}
+
+	indices.swap(out);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+									 const std::vector<uint32_t>& clusters, unsigned cacheSize, float threshold) {
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	if (triangleCount == 0) {
+		return;
+	}
+
+	std::vector<uint32_t> hard(clusters);
+	if (hard.empty() || hard.front() != 0) hard.insert(hard.begin(), 0);
+	hard.push_back(triangleCount);
+
+	// split hard clusters wherever the running ACMR is already close to the
+	// cluster's overall ACMR; cutting there costs little cache efficiency
+	std::vector<uint32_t> starts;
+	FifoCache cache(vertices.size(), cacheSize);
+	for (size_t h = 0; h + 1 < hard.size(); ++h) {
+		uint32_t begin = hard[h], end = hard[h + 1];
+		if (begin >= end) continue;
+
+		cache.Flush();
+		unsigned clusterMisses = 0;
+		for (uint32_t t = begin; t < end; ++t) {
+			clusterMisses += cache.TouchTriangle(&indices[t * 3]);
+		}
+		float limit = threshold * float(clusterMisses) / float(end - begin);
+
+		cache.Flush();
+		uint32_t start = begin;
+		unsigned misses = 0;
+		starts.push_back(begin);
+		for (uint32_t t = begin; t < end; ++t) {
+			misses += cache.TouchTriangle(&indices[t * 3]);
+			if (t + 1 < end && float(misses) / float(t + 1 - start) <= limit) {
+				start = t + 1;
+				misses = 0;
+				starts.push_back(start);
+				cache.Flush();
+			}
+		}
+	}
+	starts.push_back(triangleCount);
+
+	// sort clusters by how far out they face from the mesh centroid
+	size_t clusterCount = starts.size() - 1;
+	std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+	std::vector<float>     areas(clusterCount, 0.0f);
+	glm::vec3 meshCentroid(0.0f);
+	float     meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusterCount; ++c) {
+		for (uint32_t t = starts[c]; t < starts[c + 1]; ++t) {
+			const glm::vec3& p0 = vertices[indices[t * 3 + 0]].position;
+			const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+			const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);   // length is twice the area
+			float area = glm::length(n);
+			centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			normals[c]   += n;
+			areas[c]     += area;
+		}
+		meshCentroid += centroids[c];
+		meshArea     += areas[c];
+		if (areas[c] > 0.0f) centroids[c] /= areas[c];
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	std::vector<float> sortKey(clusterCount, 0.0f);
+	for (size_t c = 0; c < clusterCount; ++c) {
+		float len = glm::length(normals[c]);
+		if (len > 0.0f) {
+			sortKey[c] = glm::dot(centroids[c] - meshCentroid, normals[c] / len);
+		}
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<uint32_t> out;
+	out.reserve(indices.size());
+	for (uint32_t c : order) {
+		out.insert(out.end(), indices.begin() + starts[c] * 3, indices.begin() + starts[c + 1] * 3);
+	}
+	indices.swap(out);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	const uint32_t unused = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(vertices.size(), unused);
+	uint32_t next = 0;
+	for (uint32_t& v : indices) {
+		if (remap[v] == unused) remap[v] = next++;
+		v = remap[v];
+	}
+
+	std::vector<Vertex> out(next);
+	for (size_t v = 0; v < vertices.size(); ++v) {
+		if (remap[v] != unused) out[remap[v]] = vertices[v];
+	}
+	vertices.swap(out);
+}
+
+void MeshOptimizer::Optimize(MeshGeometry& mesh) {
+	CacheStats before = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+	std::vector<uint32_t> clusters;
+	OptimizeVertexCache(mesh.indices, mesh.vertices.size(), DefaultCacheSize, &clusters);
+	OptimizeOverdraw(mesh.indices, mesh.vertices, clusters);
+
+	// LOD levels share the vertex buffer, so they are renumbered together
+	if (mesh.lods.empty()) {
+		OptimizeVertexFetch(mesh.vertices, mesh.indices);
+	} else {
+		std::vector<uint32_t> all(mesh.indices);
+		for (MeshLod& lod : mesh.lods) {
+			OptimizeVertexCache(lod.indices, mesh.vertices.size());
+			all.insert(all.end(), lod.indices.begin(), lod.indices.end());
+		}
+		OptimizeVertexFetch(mesh.vertices, all);
+
+		auto at = all.begin();
+		std::copy(at, at + mesh.indices.size(), mesh.indices.begin());
+		at += mesh.indices.size();
+		for (MeshLod& lod : mesh.lods) {
+			std::copy(at, at + lod.indices.size(), lod.indices.begin());
+			at += lod.indices.size();
+		}
+	}
+
+	CacheStats after = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+	Logger::Info("Optimized mesh (" + std::to_string(mesh.indices.size() / 3) + " tris): ACMR "
+				 + Fixed(before.acmr) + " -> " + Fixed(after.acmr) + ", ATVR "
+				 + Fixed(before.atvr) + " -> " + Fixed(after.atvr));
+}
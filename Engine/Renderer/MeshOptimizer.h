@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+#include <cstdint>
+
+// Index/vertex reordering passes for indexed triangle lists. None of them
+// change what is drawn, only the order, so the renderers' draw loops stay
+// the same and simply hit the post-transform cache and early-Z more often.
+namespace MeshOptimizer {
+	constexpr unsigned DefaultCacheSize = 16;
+
+	struct CacheStats {
+		float acmr = 0.0f;   // average cache miss ratio: transformed vertices per triangle (0.5 .. 3)
+		float atvr = 0.0f;   // average transform to vertex ratio: transformed / referenced vertices (1 is ideal)
+	};
+
+	// Simulates a FIFO post-transform cache of `cacheSize` entries.
+	CacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+								  unsigned cacheSize = DefaultCacheSize);
+
+	// Tipsify (Sander, Nehab, Barczak 2007). Reorders triangles so that
+	// consecutive ones reuse recently transformed vertices. When `clusters`
+	// is given it receives the triangle offsets where the walk hit a dead end,
+	// which OptimizeOverdraw uses as hard cluster boundaries.
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+							 unsigned cacheSize = DefaultCacheSize,
+							 std::vector<uint32_t>* clusters = nullptr);
+
+	// Splits the cache-optimized order into clusters whose local cache
+	// efficiency stays within `threshold` of the whole cluster, then sorts the
+	// clusters so outward-facing ones are drawn first and occlude the rest.
+	void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+						  const std::vector<uint32_t>& clusters, unsigned cacheSize = DefaultCacheSize,
+						  float threshold = 1.05f);
+
+	// Renumbers vertices in order of first use and drops unreferenced ones so
+	// vertex fetches walk memory linearly.
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Runs the three passes in order and logs ACMR/ATVR before and after.
+	// LOD levels get the cache pass too and share the fetch renumbering.
+	void Optimize(MeshGeometry& mesh);
+}
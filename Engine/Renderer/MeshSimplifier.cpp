@@ -0,0 +1,355 @@
+#include "MeshSimplifier.h"
+#include "../Core/Logger.h"
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+	constexpr uint32_t Invalid = std::numeric_limits<uint32_t>::max();
+
+	// open borders are held in place by planes through the border edge,
+	// weighted this much more than the surface itself
+	constexpr double BorderWeight = 10.0;
+
+	// a collapse is rejected when it turns a triangle by more than ~78 degrees
+	constexpr float FlipThreshold = 0.2f;
+
+	enum VertexKind : uint8_t {
+		Kind_Interior,
+		Kind_Border,    // on exactly one open edge loop, may slide along it
+		Kind_Locked,    // non-manifold, never moves
+	};
+
+	// Symmetric 4x4 quadric, stored as the upper triangle of A, b, c and the
+	// summed weight so errors can be reported as a distance.
+	struct Quadric {
+		double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+		double b0 = 0, b1 = 0, b2 = 0, c = 0, w = 0;
+
+		void AddPlane(const glm::vec3& n, float d, double weight) {
+			double x = n.x, y = n.y, z = n.z;
+			a00 += weight * x * x; a11 += weight * y * y; a22 += weight * z * z;
+			a01 += weight * x * y; a02 += weight * x * z; a12 += weight * y * z;
+			b0  += weight * x * d; b1  += weight * y * d; b2  += weight * z * d;
+			c   += weight * double(d) * d;
+			w   += weight;
+		}
+
+		void Add(const Quadric& q) {
+			a00 += q.a00; a11 += q.a11; a22 += q.a22;
+			a01 += q.a01; a02 += q.a02; a12 += q.a12;
+			b0  += q.b0;  b1  += q.b1;  b2  += q.b2;
+			c   += q.c;   w   += q.w;
+		}
+
+		// weighted squared distance of p to all accumulated planes
+		double Evaluate(const glm::vec3& p) const {
+			double x = p.x, y = p.y, z = p.z;
+			double v = a00 * x * x + a11 * y * y + a22 * z * z
+					 + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+					 + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return v > 0.0 ? v : 0.0;
+		}
+	};
+
+	// error of collapsing onto `p` with the merged quadric of both endpoints
+	float CollapseError(const Quadric& a, const Quadric& b, const glm::vec3& p) {
+		double w = a.w + b.w;
+		if (w <= 0.0) return 0.0f;
+		return static_cast<float>(std::sqrt((a.Evaluate(p) + b.Evaluate(p)) / w));
+	}
+
+	struct Edge {
+		uint32_t a, b;   // position ids, a < b
+		bool operator<(const Edge& o) const { return a != o.a ? a < o.a : b < o.b; }
+		bool operator==(const Edge& o) const { return a == o.a && b == o.b; }
+	};
+
+	struct Collapse {
+		uint32_t from, to;
+		float    error;
+	};
+
+	// Vertices split only by normal/UV share a position id, so the topology
+	// (and the collapses) are computed on positions.
+	void BuildPositionIds(const std::vector<Vertex>& vertices, std::vector<uint32_t>& posOf, std::vector<uint32_t>& posVertex) {
+		auto key = [&](uint32_t v, uint32_t out[3]) { memcpy(out, &vertices[v].position, sizeof(uint32_t) * 3); };
+
+		std::vector<uint32_t> order(vertices.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) {
+			uint32_t kl[3], kr[3];
+			key(l, kl); key(r, kr);
+			return std::lexicographical_compare(kl, kl + 3, kr, kr + 3);
+		});
+
+		posOf.assign(vertices.size(), 0);
+		posVertex.clear();
+		uint32_t prev[3] = {};
+		for (size_t i = 0; i < order.size(); ++i) {
+			uint32_t k[3];
+			key(order[i], k);
+			if (i == 0 || memcmp(k, prev, sizeof(k)) != 0) {
+				posVertex.push_back(order[i]);
+				memcpy(prev, k, sizeof(k));
+			}
+			posOf[order[i]] = static_cast<uint32_t>(posVertex.size() - 1);
+		}
+	}
+
+	// sorted position-level edges of the current triangles, with duplicates
+	void CollectEdges(const std::vector<uint32_t>& tris, const std::vector<uint32_t>& posOf, std::vector<Edge>& edges) {
+		edges.clear();
+		edges.reserve(tris.size());
+		for (size_t t = 0; t < tris.size(); t += 3) {
+			for (int e = 0; e < 3; ++e) {
+				uint32_t a = posOf[tris[t + e]], b = posOf[tris[t + (e + 1) % 3]];
+				edges.push_back(a < b ? Edge{ a, b } : Edge{ b, a });
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+	}
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+											   size_t targetIndexCount, float maxError, float* resultError) {
+	float appliedError = 0.0f;
+	if (resultError) *resultError = 0.0f;
+
+	std::vector<uint32_t> posOf, posVertex;
+	BuildPositionIds(vertices, posOf, posVertex);
+	const size_t posCount = posVertex.size();
+
+	std::vector<glm::vec3> pos(posCount);
+	for (size_t p = 0; p < posCount; ++p) pos[p] = vertices[posVertex[p]].position;
+
+	// drop triangles that are already degenerate at the position level
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		uint32_t p0 = posOf[indices[t]], p1 = posOf[indices[t + 1]], p2 = posOf[indices[t + 2]];
+		if (p0 != p1 && p1 != p2 && p0 != p2) {
+			result.insert(result.end(), indices.begin() + t, indices.begin() + t + 3);
+		}
+	}
+	if (result.size() <= targetIndexCount) {
+		return result;
+	}
+
+	// surface quadrics, area weighted
+	std::vector<Quadric> quadrics(posCount);
+	for (size_t t = 0; t < result.size(); t += 3) {
+		uint32_t p[3] = { posOf[result[t]], posOf[result[t + 1]], posOf[result[t + 2]] };
+		glm::vec3 n = glm::cross(pos[p[1]] - pos[p[0]], pos[p[2]] - pos[p[0]]);
+		float len = glm::length(n);
+		if (len <= 0.0f) continue;
+		n /= len;
+		float d = -glm::dot(n, pos[p[0]]);
+		for (uint32_t v : p) quadrics[v].AddPlane(n, d, len * 0.5);
+	}
+
+	// border quadrics: a plane through each open edge, perpendicular to its triangle
+	std::vector<Edge> edges;
+	CollectEdges(result, posOf, edges);
+	for (size_t t = 0; t < result.size(); t += 3) {
+		for (int e = 0; e < 3; ++e) {
+			uint32_t a = posOf[result[t + e]], b = posOf[result[t + (e + 1) % 3]];
+			Edge key = a < b ? Edge{ a, b } : Edge{ b, a };
+			auto range = std::equal_range(edges.begin(), edges.end(), key);
+			if (range.second - range.first != 1) continue;
+
+			uint32_t c = posOf[result[t + (e + 2) % 3]];
+			glm::vec3 edge = pos[b] - pos[a];
+			glm::vec3 faceNormal = glm::cross(edge, pos[c] - pos[a]);
+			glm::vec3 n = glm::cross(edge, faceNormal);
+			float len = glm::length(n);
+			if (len <= 0.0f) continue;
+			n /= len;
+			float d = -glm::dot(n, pos[a]);
+			double weight = double(glm::dot(edge, edge)) * BorderWeight;
+			quadrics[a].AddPlane(n, d, weight);
+			quadrics[b].AddPlane(n, d, weight);
+		}
+	}
+
+	std::vector<uint8_t>   kind(posCount);
+	std::vector<uint8_t>   touched(posCount);
+	std::vector<uint32_t>  collapseTo(posCount);
+	std::vector<uint32_t>  fallback(posCount);
+	std::vector<uint32_t>  wedge(vertices.size());
+	std::vector<uint32_t>  adjOffsets(posCount + 1);
+	std::vector<uint32_t>  adjacency;
+	std::vector<Collapse>  collapses;
+	std::vector<uint32_t>  next;
+
+	while (result.size() > targetIndexCount) {
+		// classify vertices from this pass's edge counts
+		CollectEdges(result, posOf, edges);
+		std::fill(kind.begin(), kind.end(), uint8_t(Kind_Interior));
+		collapses.clear();
+		for (size_t i = 0; i < edges.size();) {
+			size_t j = i + 1;
+			while (j < edges.size() && edges[j] == edges[i]) ++j;
+			uint8_t edgeKind = j - i == 1 ? Kind_Border : j - i == 2 ? Kind_Interior : Kind_Locked;
+			kind[edges[i].a] = std::max(kind[edges[i].a], edgeKind);
+			kind[edges[i].b] = std::max(kind[edges[i].b], edgeKind);
+			i = j;
+		}
+
+		// one candidate per edge, in the cheaper allowed direction
+		for (size_t i = 0; i < edges.size();) {
+			size_t j = i + 1;
+			while (j < edges.size() && edges[j] == edges[i]) ++j;
+			bool borderEdge = j - i == 1;
+			uint32_t a = edges[i].a, b = edges[i].b;
+			i = j;
+
+			auto allowed = [&](uint32_t from, uint32_t to) {
+				if (kind[from] == Kind_Interior) return true;
+				return kind[from] == Kind_Border && borderEdge && kind[to] != Kind_Interior;
+			};
+
+			Collapse best{ Invalid, Invalid, std::numeric_limits<float>::max() };
+			if (allowed(a, b)) best = { a, b, CollapseError(quadrics[a], quadrics[b], pos[b]) };
+			if (allowed(b, a)) {
+				float error = CollapseError(quadrics[a], quadrics[b], pos[a]);
+				if (error < best.error) best = { b, a, error };
+			}
+			if (best.from != Invalid) collapses.push_back(best);
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.error < r.error; });
+
+		// position -> triangle adjacency for the flip test
+		std::fill(adjOffsets.begin(), adjOffsets.end(), 0u);
+		for (uint32_t v : result) ++adjOffsets[posOf[v] + 1];
+		for (size_t p = 0; p < posCount; ++p) adjOffsets[p + 1] += adjOffsets[p];
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); ++i) {
+				adjacency[fill[posOf[result[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		std::fill(touched.begin(), touched.end(), uint8_t(0));
+		std::iota(collapseTo.begin(), collapseTo.end(), 0u);
+		std::fill(wedge.begin(), wedge.end(), Invalid);
+
+		// every collapse removes at least one triangle; stop once enough are gone
+		size_t needed  = (result.size() - targetIndexCount + 2) / 3;
+		size_t removed = 0;
+		size_t applied = 0;
+
+		for (const Collapse& c : collapses) {
+			if (c.error > maxError || removed >= needed) break;
+			if (touched[c.from] || touched[c.to]) continue;
+
+			bool flips = false;
+			for (uint32_t k = adjOffsets[c.from]; k < adjOffsets[c.from + 1] && !flips; ++k) {
+				const uint32_t* tri = &result[adjacency[k] * 3];
+				uint32_t p[3] = { posOf[tri[0]], posOf[tri[1]], posOf[tri[2]] };
+				if (p[0] == c.to || p[1] == c.to || p[2] == c.to) continue;
+
+				glm::vec3 before = glm::cross(pos[p[1]] - pos[p[0]], pos[p[2]] - pos[p[0]]);
+				glm::vec3 q[3];
+				for (int i = 0; i < 3; ++i) q[i] = pos[p[i] == c.from ? c.to : p[i]];
+				glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+
+				float lenBefore = glm::length(before);
+				if (lenBefore <= 0.0f) continue;
+				flips = glm::dot(before, after) <= FlipThreshold * lenBefore * glm::length(after);
+			}
+			if (flips) continue;
+
+			// freeze the one-ring so later collapses in this pass see the same triangles
+			for (uint32_t k = adjOffsets[c.from]; k < adjOffsets[c.from + 1]; ++k) {
+				const uint32_t* tri = &result[adjacency[k] * 3];
+				for (int i = 0; i < 3; ++i) touched[posOf[tri[i]]] = 1;
+
+				// corners of triangles that die with the edge tell which wedge
+				// of `to` each wedge of `from` should become
+				uint32_t va = Invalid, vb = Invalid;
+				for (int i = 0; i < 3; ++i) {
+					if (posOf[tri[i]] == c.from) va = tri[i];
+					if (posOf[tri[i]] == c.to)   vb = tri[i];
+				}
+				if (vb != Invalid) {
+					wedge[va] = vb;
+					fallback[c.from] = vb;
+					++removed;
+				}
+			}
+
+			collapseTo[c.from] = c.to;
+			quadrics[c.to].Add(quadrics[c.from]);
+			appliedError = std::max(appliedError, c.error);
+			++applied;
+		}
+
+		if (applied == 0) {
+			break;
+		}
+
+		next.clear();
+		next.reserve(result.size());
+		for (size_t t = 0; t < result.size(); t += 3) {
+			uint32_t v[3];
+			for (int i = 0; i < 3; ++i) {
+				v[i] = result[t + i];
+				uint32_t p = posOf[v[i]];
+				if (collapseTo[p] != p) {
+					v[i] = wedge[v[i]] != Invalid ? wedge[v[i]] : fallback[p];
+				}
+			}
+			uint32_t p0 = posOf[v[0]], p1 = posOf[v[1]], p2 = posOf[v[2]];
+			if (p0 != p1 && p1 != p2 && p0 != p2) {
+				next.insert(next.end(), v, v + 3);
+			}
+		}
+		result.swap(next);
+	}
+
+	if (resultError) *resultError = appliedError;
+	return result;
+}
+
+void MeshSimplifier::GenerateLods(MeshGeometry& mesh) {
+	mesh.lods.clear();
+	if (mesh.indices.size() < 3) {
+		return;
+	}
+
+	float maxError = glm::length(mesh.boundsMax - mesh.boundsMin) * LodMaxRelativeError;
+	size_t previous = mesh.indices.size();
+	float  previousError = 0.0f;
+	std::string summary = std::to_string(previous / 3);
+
+	while (mesh.LodCount() < MaxMeshLods) {
+		size_t target = size_t((previous / 3) * LodReduction) * 3;
+		if (target < 3) break;
+
+		// each level starts from the full mesh so its error is measured against it
+		float error = 0.0f;
+		std::vector<uint32_t> lod = Simplify(mesh.vertices, mesh.indices, target, maxError, &error);
+
+		// not worth a level unless it saves at least a quarter of the previous one
+		if (lod.empty() || lod.size() > previous * 3 / 4) break;
+
+		previous      = lod.size();
+		previousError = std::max(previousError, error);
+
+		char buf[64];
+		snprintf(buf, sizeof(buf), " -> %zu (%.4f)", lod.size() / 3, previousError);
+		summary += buf;
+
+		MeshLod level;
+		level.indices = std::move(lod);
+		level.error   = previousError;
+		mesh.lods.push_back(std::move(level));
+	}
+
+	Logger::Info("Generated " + std::to_string(mesh.lods.size()) + " LODs, tris (error): " + summary);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+#include <cstdint>
+
+// Quadric error metric simplification (Garland & Heckbert 1997). Edges are
+// collapsed onto one of their existing endpoints, so every level indexes the
+// original vertex buffer and only needs its own index list.
+namespace MeshSimplifier {
+	// Each generated level aims for this fraction of the previous level's triangles.
+	constexpr float LodReduction = 0.5f;
+
+	// Largest error a level may reach, as a fraction of the bounds diagonal.
+	constexpr float LodMaxRelativeError = 0.05f;
+
+	// Collapses edges in order of quadric cost until at most `targetIndexCount`
+	// indices remain or the next collapse would move the surface by more than
+	// `maxError` (object units). Collapses that flip a triangle are skipped and
+	// open borders only slide along themselves. `resultError` receives the
+	// largest error of any collapse that was applied.
+	std::vector<uint32_t> Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+								   size_t targetIndexCount, float maxError, float* resultError = nullptr);
+
+	// Replaces mesh.lods with up to MaxMeshLods - 1 coarser levels, stopping
+	// early once a level no longer gets meaningfully smaller.
+	void GenerateLods(MeshGeometry& mesh);
+}
@@ -1,39 +1,166 @@
 #include "Model.h"
+#include "RendererManager.h"
+#include "TextureManager.h"
 #include "../Core/Logger.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/config.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
 
 namespace Renderer {
-bool Model::LoadFromFile(const std::string& path) {
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path,
-        aiProcess_Triangulate | aiProcess_GenNormals |
-        aiProcess_OptimizeMeshes | aiProcess_CalcTangentSpace |
-        aiProcess_JoinIdenticalVertices);
+namespace {
+    using Clock = std::chrono::steady_clock;
 
-    if (!scene || !scene->HasMeshes()) {
-        Logger::Error("Failed to load model: " + path);
-        return false;
+    double MillisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::string Fixed(double value) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.1f", value);
+        return buf;
     }
 
-    for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
-        aiMesh* meshSrc = scene->mMeshes[m];
-        std::vector<Vertex> verts;
+    // Converts straight into the final vectors, which are then moved into
+    // the geometry; nothing is copied after this point.
+    std::shared_ptr<MeshGeometry> ConvertMesh(const aiMesh* src) {
+        std::vector<Vertex> verts(src->mNumVertices);
+        for (unsigned int i = 0; i < src->mNumVertices; ++i) {
+            const aiVector3D& p = src->mVertices[i];
+            verts[i].position = glm::vec3(p.x, p.y, p.z);
+            if (src->HasNormals()) {
+                const aiVector3D& n = src->mNormals[i];
+                verts[i].normal = glm::vec3(n.x, n.y, n.z);
+            }
+            if (src->HasTextureCoords(0)) {
+                const aiVector3D& t = src->mTextureCoords[0][i];
+                verts[i].texcoord = glm::vec2(t.x, t.y);
+            }
+        }
+
         std::vector<uint32_t> idxs;
+        idxs.reserve(size_t(src->mNumFaces) * 3);
+        for (unsigned int f = 0; f < src->mNumFaces; ++f) {
+            const aiFace& face = src->mFaces[f];
+            if (face.mNumIndices != 3) {
+                continue;   // stray point/line left over after triangulation
+            }
+            idxs.insert(idxs.end(), face.mIndices, face.mIndices + 3);
+        }
 
-        // Fill verts & idxs just like in Mesh::LoadFromOBJ...
-        for (unsigned int i = 0; i < meshSrc->mNumVertices; ++i) {
-            // convert aiMesh vertex → Vertex
+        return std::make_shared<MeshGeometry>(std::move(verts), std::move(idxs));
+    }
+
+    // The mesh material's first diffuse texture, resolved against the
+    // model's folder. Textures embedded in the file ("*0") are skipped, as
+    // are meshes with no coordinates to map one with.
+    std::shared_ptr<Texture> DiffuseTexture(const aiScene* scene, const aiMesh* src, const std::filesystem::path& folder) {
+        if (!src->HasTextureCoords(0) || src->mMaterialIndex >= scene->mNumMaterials) {
+            return nullptr;
+        }
+        aiString file;
+        if (scene->mMaterials[src->mMaterialIndex]->GetTexture(aiTextureType_DIFFUSE, 0, &file) != AI_SUCCESS
+            || file.length == 0 || file.data[0] == '*') {
+            return nullptr;
         }
-        for (unsigned int f = 0; f < meshSrc->mNumFaces; ++f) {
-            // convert aiFace indices → idxs
+        return TextureManager::Load((folder / file.C_Str()).lexically_normal().string());
+    }
+}
+
+unsigned int ImportFlagsFor(ImportProfile profile) {
+    const unsigned int common = aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_PreTransformVertices;
+    switch (profile) {
+    case ImportProfile::Fast:
+        return common | aiProcessPreset_TargetRealtime_Fast;
+    case ImportProfile::Quality:
+        return common | aiProcessPreset_TargetRealtime_MaxQuality;
+    case ImportProfile::Default:
+    default:
+        return common | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals
+             | aiProcess_ImproveCacheLocality | aiProcess_FindDegenerates | aiProcess_FindInvalidData;
+    }
+}
+
+bool Model::LoadFromFile(const std::string& path, ImportProfile profile, uint32_t loadFlags, unsigned threadCount) {
+    meshes.clear();
+    timings = ModelLoadTimings();
+
+    auto start = Clock::now();
+    Assimp::Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    const aiScene* scene = importer.ReadFile(path, ImportFlagsFor(profile));
+    timings.readMs = MillisecondsSince(start);
+
+    if (!scene || !scene->HasMeshes()) {
+        Logger::Error("Failed to load model: " + path + " (" + importer.GetErrorString() + ")");
+        return false;
+    }
+
+    // meshes differ wildly in size, so workers pull the next one off a shared counter
+    start = Clock::now();
+    const size_t meshCount = scene->mNumMeshes;
+    std::vector<std::shared_ptr<MeshGeometry>> converted(meshCount);
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t m = next++; m < meshCount; m = next++) {
+            converted[m] = ConvertMesh(scene->mMeshes[m]);
+            converted[m]->ApplyLoadFlags(loadFlags);
         }
+    };
+
+    if (threadCount == 0) {
+        threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>((std::min)(size_t(threadCount), meshCount));
 
-        // Now emplace into meshes vector
-        meshes.emplace_back(verts, idxs);
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        workers.emplace_back(worker);
     }
-    Logger::Info("Model loaded: " + path);
-    return true;
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    // textures load in the background and show up once they're on the GPU
+    const std::filesystem::path folder = std::filesystem::path(path).parent_path();
+    size_t vertexCount = 0, triangleCount = 0, textureCount = 0;
+    meshes.reserve(meshCount);
+    for (size_t m = 0; m < meshCount; ++m) {
+        auto& geometry = converted[m];
+        if (geometry->indices.empty()) {
+            continue;
+        }
+        vertexCount   += geometry->VertexCount();
+        triangleCount += geometry->indices.size() / 3;
+        auto mesh = std::make_shared<Mesh>(std::move(geometry));
+        mesh->texture = DiffuseTexture(scene, scene->mMeshes[m], folder);
+        textureCount += mesh->texture ? 1 : 0;
+        meshes.push_back(std::move(mesh));
+    }
+    timings.convertMs = MillisecondsSince(start);
+
+    Logger::Info("Model loaded: " + path + " (" + std::to_string(meshes.size()) + " meshes, "
+                 + std::to_string(vertexCount) + " verts, " + std::to_string(triangleCount) + " tris, "
+                 + std::to_string(textureCount) + " textured) read "
+                 + Fixed(timings.readMs) + " ms, convert " + Fixed(timings.convertMs) + " ms on "
+                 + std::to_string(threadCount) + " threads");
+    return !meshes.empty();
+}
+
+bool Model::Upload() {
+    auto start = Clock::now();
+    bool ok = RendererManager::SetMeshes(meshes);
+    timings.uploadMs = MillisecondsSince(start);
+
+    Logger::Info("Model uploaded: " + std::to_string(meshes.size()) + " meshes in " + Fixed(timings.uploadMs) + " ms");
+    return ok;
 }
 }
@@ -3,11 +3,40 @@
 #include "Mesh.h"
 #include <vector>
 #include <string>
+#include <memory>
 
 namespace Renderer {
+// Assimp post-processing presets. Every profile triangulates, drops point
+// and line primitives and bakes the node hierarchy into the vertices, since
+// meshes carry no parent transform of their own.
+enum class ImportProfile {
+    Fast,       // aiProcessPreset_TargetRealtime_Fast
+    Default,    // welded, smooth normals, cache-friendly order
+    Quality     // aiProcessPreset_TargetRealtime_MaxQuality
+};
+
+unsigned int ImportFlagsFor(ImportProfile profile);
+
+struct ModelLoadTimings {
+    double readMs    = 0.0;   // Assimp ReadFile, including its post-processing
+    double convertMs = 0.0;   // aiMesh -> MeshGeometry, plus any MeshLoadFlags steps
+    double uploadMs  = 0.0;   // RendererManager::SetMeshes
+};
+
 class Model {
 public:
-    std::vector<Mesh> meshes;
-    bool LoadFromFile(const std::string& path);
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    ModelLoadTimings timings;
+
+    // Imports every mesh in the file. Meshes are converted in parallel on
+    // `threadCount` threads (0 = one per core, at most one per mesh) and
+    // `loadFlags` (MeshLoadFlags) are applied on those threads as well.
+    bool LoadFromFile(const std::string& path,
+                      ImportProfile profile = ImportProfile::Default,
+                      uint32_t loadFlags = MeshLoad_Default,
+                      unsigned threadCount = 0);
+
+    // Hands the meshes to the active renderer in one SetMeshes call.
+    bool Upload();
 };
 }
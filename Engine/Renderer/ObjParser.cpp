@@ -0,0 +1,339 @@
+#include "ObjParser.h"
+#include "../Core/MappedFile.h"
+#include "../Core/Logger.h"
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+
+namespace {
+	struct LineCounts {
+		size_t positions = 0;
+		size_t texcoords = 0;
+		size_t normals   = 0;
+		size_t faces     = 0;
+	};
+
+	inline bool IsBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipBlanks(const char* p, const char* end) {
+		while (p < end && IsBlank(*p)) ++p;
+		return p;
+	}
+
+	// end of the line starting at p (the '\n' or `end`)
+	inline const char* LineEnd(const char* p, const char* end) {
+		const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+		return nl ? nl : end;
+	}
+
+	// cheap first pass so the output vectors are allocated exactly once
+	LineCounts PreScan(const char* p, const char* end) {
+		LineCounts counts;
+		while (p < end) {
+			const char* lineEnd = LineEnd(p, end);
+			if (lineEnd - p >= 2) {
+				if (p[0] == 'v') {
+					if (IsBlank(p[1]))   ++counts.positions;
+					else if (p[1] == 't') ++counts.texcoords;
+					else if (p[1] == 'n') ++counts.normals;
+				} else if (p[0] == 'f' && IsBlank(p[1])) {
+					++counts.faces;
+				}
+			}
+			p = lineEnd + 1;
+		}
+		return counts;
+	}
+
+	inline const char* ParseFloat(const char* p, const char* end, float& value) {
+		p = SkipBlanks(p, end);
+		if (p < end && *p == '+') ++p; // from_chars does not accept a leading '+'
+		auto result = std::from_chars(p, end, value);
+		if (result.ec != std::errc()) {
+			value = 0.0f;
+			return p;
+		}
+		return result.ptr;
+	}
+
+	// Parses "v", "v/vt", "v//vn" or "v/vt/vn". Missing parts stay 0.
+	inline const char* ParseCorner(const char* p, const char* end, int32_t raw[3]) {
+		raw[0] = raw[1] = raw[2] = 0;
+		auto result = std::from_chars(p, end, raw[0]);
+		if (result.ec != std::errc()) {
+			return nullptr;
+		}
+		p = result.ptr;
+		for (int slot = 1; slot < 3 && p < end && *p == '/'; ++slot) {
+			++p;
+			if (p < end && *p != '/') {
+				result = std::from_chars(p, end, raw[slot]);
+				if (result.ec == std::errc()) {
+					p = result.ptr;
+				}
+			}
+		}
+		return p;
+	}
+
+	size_t LineNumber(const char* begin, const char* at) {
+		return 1 + std::count(begin, at, '\n');
+	}
+
+	// A newline-aligned slice of the file, parsed independently. Positive OBJ
+	// indices are already global; negative (relative) ones are stored relative
+	// to the chunk and listed in `relative` until the prefix sums are known.
+	struct Chunk {
+		const char*         begin = nullptr;
+		const char*         end   = nullptr;
+		ObjParser::ObjData  data;
+		std::vector<size_t> relative;   // corner * 3 + attribute
+		const char*         syntaxError = nullptr;
+
+		// filled by the stitch pass
+		size_t positionBase = 0, texcoordBase = 0, normalBase = 0, cornerBase = 0;
+		size_t badCorner    = SIZE_MAX;
+	};
+
+	// one face corner plus which of its indices are chunk-relative
+	struct PendingCorner {
+		ObjParser::Corner corner;
+		uint8_t           relativeMask;
+	};
+
+	inline int32_t StoreIndex(int32_t raw, size_t localCount, int attribute, uint8_t& relativeMask) {
+		if (raw > 0) {
+			return raw - 1;
+		}
+		if (raw < 0) {
+			relativeMask |= uint8_t(1u << attribute);
+			return static_cast<int32_t>(int64_t(localCount) + raw);
+		}
+		return -1;
+	}
+
+	inline void PushCorner(Chunk& chunk, const PendingCorner& pc) {
+		size_t corner = chunk.data.corners.size();
+		chunk.data.corners.push_back(pc.corner);
+		for (int attribute = 0; attribute < 3; ++attribute) {
+			if (pc.relativeMask & (1u << attribute)) {
+				chunk.relative.push_back(corner * 3 + attribute);
+			}
+		}
+	}
+
+	void ParseChunk(Chunk& chunk) {
+		ObjParser::ObjData& out = chunk.data;
+		const char* end = chunk.end;
+
+		LineCounts counts = PreScan(chunk.begin, end);
+		out.positions.reserve(counts.positions);
+		out.texcoords.reserve(counts.texcoords);
+		out.normals.reserve(counts.normals);
+		out.corners.reserve(counts.faces * 3);
+
+		const char* p = chunk.begin;
+		while (p < end) {
+			const char* lineEnd = LineEnd(p, end);
+			const char* q = SkipBlanks(p, lineEnd);
+
+			// keyword runs up to the first blank
+			const char* keyEnd = q;
+			while (keyEnd < lineEnd && !IsBlank(*keyEnd)) ++keyEnd;
+			size_t keyLen = keyEnd - q;
+
+			if (keyLen == 1 && q[0] == 'v') {
+				glm::vec3 pos;
+				q = ParseFloat(keyEnd, lineEnd, pos.x);
+				q = ParseFloat(q, lineEnd, pos.y);
+				ParseFloat(q, lineEnd, pos.z);
+				out.positions.push_back(pos);
+			}
+			else if (keyLen == 2 && q[0] == 'v' && q[1] == 't') {
+				glm::vec2 uv;
+				q = ParseFloat(keyEnd, lineEnd, uv.x);
+				ParseFloat(q, lineEnd, uv.y);
+				out.texcoords.push_back(uv);
+			}
+			else if (keyLen == 2 && q[0] == 'v' && q[1] == 'n') {
+				glm::vec3 n;
+				q = ParseFloat(keyEnd, lineEnd, n.x);
+				q = ParseFloat(q, lineEnd, n.y);
+				ParseFloat(q, lineEnd, n.z);
+				out.normals.push_back(n);
+			}
+			else if (keyLen == 1 && q[0] == 'f') {
+				PendingCorner first{}, prev{};
+				int cornerCount = 0;
+				q = keyEnd;
+				while (true) {
+					q = SkipBlanks(q, lineEnd);
+					if (q >= lineEnd) break;
+
+					int32_t raw[3];
+					const char* next = ParseCorner(q, lineEnd, raw);
+					if (!next || raw[0] == 0) {
+						chunk.syntaxError = q;
+						return;
+					}
+					q = next;
+
+					PendingCorner pc{};
+					pc.corner.position = StoreIndex(raw[0], out.positions.size(), 0, pc.relativeMask);
+					pc.corner.texcoord = StoreIndex(raw[1], out.texcoords.size(), 1, pc.relativeMask);
+					pc.corner.normal   = StoreIndex(raw[2], out.normals.size(),   2, pc.relativeMask);
+
+					// fan-triangulate anything with more than three corners
+					if (cornerCount == 0) {
+						first = pc;
+					} else if (cornerCount >= 2) {
+						PushCorner(chunk, first);
+						PushCorner(chunk, prev);
+						PushCorner(chunk, pc);
+					}
+					prev = pc;
+					++cornerCount;
+				}
+			}
+			// everything else (#, o, g, s, mtllib, usemtl) is ignored
+
+			p = lineEnd + 1;
+		}
+	}
+
+	// Copies a chunk into its slot of the merged arrays, adds the prefix to its
+	// relative indices and range-checks every corner against the file totals.
+	void StitchChunk(Chunk& chunk, ObjParser::ObjData& out) {
+		const ObjParser::ObjData& data = chunk.data;
+		std::copy(data.positions.begin(), data.positions.end(), out.positions.begin() + chunk.positionBase);
+		std::copy(data.texcoords.begin(), data.texcoords.end(), out.texcoords.begin() + chunk.texcoordBase);
+		std::copy(data.normals.begin(),   data.normals.end(),   out.normals.begin()   + chunk.normalBase);
+
+		ObjParser::Corner* corners = out.corners.data() + chunk.cornerBase;
+		std::copy(data.corners.begin(), data.corners.end(), corners);
+
+		const size_t bases[3] = { chunk.positionBase, chunk.texcoordBase, chunk.normalBase };
+		for (size_t slot : chunk.relative) {
+			ObjParser::Corner& c = corners[slot / 3];
+			int32_t& field = slot % 3 == 0 ? c.position : slot % 3 == 1 ? c.texcoord : c.normal;
+			int64_t index = int64_t(field) + int64_t(bases[slot % 3]);
+			if (index < 0) {
+				chunk.badCorner = std::min(chunk.badCorner, slot / 3);
+				field = 0;
+				continue;
+			}
+			field = static_cast<int32_t>(index);
+		}
+
+		const int64_t positionCount = out.positions.size();
+		const int64_t texcoordCount = out.texcoords.size();
+		const int64_t normalCount   = out.normals.size();
+		for (size_t i = 0; i < data.corners.size(); ++i) {
+			const ObjParser::Corner& c = corners[i];
+			if (c.position < 0 || c.position >= positionCount
+				|| c.texcoord < -1 || c.texcoord >= texcoordCount
+				|| c.normal < -1   || c.normal >= normalCount) {
+				chunk.badCorner = std::min(chunk.badCorner, i);
+				break;
+			}
+		}
+	}
+
+	template <typename Fn>
+	void RunParallel(size_t count, Fn fn) {
+		std::vector<std::thread> workers;
+		workers.reserve(count > 0 ? count - 1 : 0);
+		for (size_t i = 1; i < count; ++i) {
+			workers.emplace_back(fn, i);
+		}
+		if (count > 0) {
+			fn(size_t(0));
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+}
+
+unsigned ObjParser::DefaultThreadCount(size_t bytes) {
+	if (bytes < ParallelMinBytes) {
+		return 1;
+	}
+	unsigned hardware = (std::max)(1u, std::thread::hardware_concurrency());
+	size_t bySize = bytes / ParallelBytesPerThread;
+	return static_cast<unsigned>((std::max)(size_t(1), (std::min)(size_t(hardware), bySize)));
+}
+
+bool ObjParser::Parse(const char* begin, const char* end, ObjData& out, unsigned threadCount) {
+	size_t size = end - begin;
+	if (threadCount == 0) {
+		threadCount = DefaultThreadCount(size);
+	}
+
+	// cut the text into newline-aligned chunks
+	std::vector<Chunk> chunks(threadCount);
+	const char* cut = begin;
+	for (unsigned i = 0; i < threadCount; ++i) {
+		chunks[i].begin = cut;
+		if (i + 1 < threadCount) {
+			const char* target = (std::max)(cut, begin + size * (i + 1) / threadCount);
+			cut = target < end ? LineEnd(target, end) : end;
+			if (cut < end) ++cut;
+		} else {
+			cut = end;
+		}
+		chunks[i].end = cut;
+	}
+
+	RunParallel(chunks.size(), [&](size_t i) { ParseChunk(chunks[i]); });
+
+	for (const Chunk& chunk : chunks) {
+		if (chunk.syntaxError) {
+			Logger::Error("OBJ: bad face on line " + std::to_string(LineNumber(begin, chunk.syntaxError)));
+			return false;
+		}
+	}
+
+	// prefix sums give every chunk its offset into the merged arrays
+	size_t positions = 0, texcoords = 0, normals = 0, corners = 0;
+	for (Chunk& chunk : chunks) {
+		chunk.positionBase = positions;
+		chunk.texcoordBase = texcoords;
+		chunk.normalBase   = normals;
+		chunk.cornerBase   = corners;
+		positions += chunk.data.positions.size();
+		texcoords += chunk.data.texcoords.size();
+		normals   += chunk.data.normals.size();
+		corners   += chunk.data.corners.size();
+	}
+
+	out.positions.resize(positions);
+	out.texcoords.resize(texcoords);
+	out.normals.resize(normals);
+	out.corners.resize(corners);
+
+	RunParallel(chunks.size(), [&](size_t i) { StitchChunk(chunks[i], out); });
+
+	for (const Chunk& chunk : chunks) {
+		if (chunk.badCorner != SIZE_MAX) {
+			size_t face = (chunk.cornerBase + chunk.badCorner) / 3 + 1;
+			Logger::Error("OBJ: triangle " + std::to_string(face) + " references a missing vertex");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ObjParser::ParseFile(const std::string& path, ObjData& out, unsigned threadCount) {
+	MappedFile file;
+	if (!file.Open(path)) {
+		Logger::Error("Failed to open OBJ file: " + path);
+		return false;
+	}
+	return Parse(file.Data(), file.Data() + file.Size(), out, threadCount);
+}
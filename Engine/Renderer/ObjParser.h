@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace ObjParser {
+	// One face corner. Indices are 0-based into the ObjData arrays,
+	// -1 when the corner does not reference that attribute ("v//vn", "v").
+	struct Corner {
+		int32_t position;
+		int32_t texcoord;
+		int32_t normal;
+	};
+
+	struct ObjData {
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> texcoords;
+		std::vector<glm::vec3> normals;
+		std::vector<Corner>    corners;   // three per triangle, polygons are fanned
+	};
+
+	// Files smaller than this are always parsed on the calling thread.
+	constexpr size_t ParallelMinBytes       = 4u << 20;
+	constexpr size_t ParallelBytesPerThread = 1u << 20;
+
+	// Thread count Parse uses for `bytes` of text when asked for 0 threads.
+	unsigned DefaultThreadCount(size_t bytes);
+
+	// Tokenizes the OBJ text in [begin, end) in place, no per-line allocations,
+	// replacing the contents of `out`. The text is split into newline-aligned
+	// chunks parsed on `threadCount` threads (0 = pick from the size) and the
+	// chunks are stitched with prefix sums, so the result is identical for any
+	// thread count. Returns false (and logs) on a face that references missing data.
+	bool Parse(const char* begin, const char* end, ObjData& out, unsigned threadCount = 1);
+
+	// Memory-maps the file and parses it.
+	bool ParseFile(const std::string& path, ObjData& out, unsigned threadCount = 0);
+}
@@ -0,0 +1,252 @@
+#include "RenderCommands.h"
+#include "IRenderer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace Renderer {
+	std::vector<std::shared_ptr<RenderCommands::ThreadBuffer>> RenderCommands::threads;
+	std::mutex                                                 RenderCommands::threadsMutex;
+
+	namespace {
+		RenderCommand Make(RenderCommandType type, int slot) {
+			RenderCommand command;
+			command.type = type;
+			command.slot = slot;
+			return command;
+		}
+
+		const char* TypeName(RenderCommandType type) {
+			switch (type) {
+				case RenderCommandType::SetMesh:      return "SetMesh";
+				case RenderCommandType::SetTransform: return "SetTransform";
+				case RenderCommandType::UpdateRange:  return "UpdateRange";
+				case RenderCommandType::DeleteMesh:   return "DeleteMesh";
+				case RenderCommandType::SetLodBias:   return "SetLodBias";
+				case RenderCommandType::SetSortDraws: return "SetSortDraws";
+				case RenderCommandType::SetDynamicResolution: return "SetDynamicResolution";
+			}
+			return "Unknown";
+		}
+	}
+
+	Transform CommandBuffer::TransformOf(const RenderCommand& command) {
+		Transform transform;
+		transform.position = glm::vec3(command.values[0], command.values[1], command.values[2]);
+		transform.rotation = glm::vec3(command.values[3], command.values[4], command.values[5]);
+		transform.scale    = glm::vec3(command.values[6], command.values[7], command.values[8]);
+		return transform;
+	}
+
+	DynamicResolutionSettings CommandBuffer::DynamicResolutionOf(const RenderCommand& command) {
+		DynamicResolutionSettings settings;
+		settings.enabled  = command.ref != 0;
+		settings.targetMs = command.values[0];
+		settings.minScale = command.values[1];
+		settings.maxScale = command.values[2];
+		return settings;
+	}
+
+	void CommandBuffer::SetMesh(int slot, std::shared_ptr<Mesh> mesh) {
+		RenderCommand command = Make(RenderCommandType::SetMesh, slot);
+		command.ref = static_cast<uint32_t>(meshes.size());
+		meshes.push_back(std::move(mesh));
+		commands.push_back(command);
+	}
+
+	void CommandBuffer::SetTransform(int slot, const Transform& transform) {
+		RenderCommand command = Make(RenderCommandType::SetTransform, slot);
+		for (int i = 0; i < 3; ++i) {
+			command.values[i]     = transform.position[i];
+			command.values[3 + i] = transform.rotation[i];
+			command.values[6 + i] = transform.scale[i];
+		}
+		commands.push_back(command);
+	}
+
+	void CommandBuffer::UpdateRange(int slot, size_t first, size_t count) {
+		RenderCommand command = Make(RenderCommandType::UpdateRange, slot);
+		command.first = first;
+		command.count = count;
+		commands.push_back(command);
+	}
+
+	void CommandBuffer::DeleteMesh(int slot) {
+		commands.push_back(Make(RenderCommandType::DeleteMesh, slot));
+	}
+
+	void CommandBuffer::SetLodBias(float bias) {
+		RenderCommand command = Make(RenderCommandType::SetLodBias, -1);
+		command.values[0] = bias;
+		commands.push_back(command);
+	}
+
+	void CommandBuffer::SetSortDraws(bool sort) {
+		RenderCommand command = Make(RenderCommandType::SetSortDraws, -1);
+		command.ref = sort ? 1 : 0;
+		commands.push_back(command);
+	}
+
+	void CommandBuffer::SetDynamicResolution(const DynamicResolutionSettings& settings) {
+		RenderCommand command = Make(RenderCommandType::SetDynamicResolution, -1);
+		command.ref       = settings.enabled ? 1 : 0;
+		command.values[0] = settings.targetMs;
+		command.values[1] = settings.minScale;
+		command.values[2] = settings.maxScale;
+		commands.push_back(command);
+	}
+
+	void CommandBuffer::Append(const CommandBuffer& other) {
+		uint32_t base = static_cast<uint32_t>(meshes.size());
+		meshes.insert(meshes.end(), other.meshes.begin(), other.meshes.end());
+		size_t start = commands.size();
+		commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+		for (size_t i = start; i < commands.size(); ++i) {
+			if (commands[i].type == RenderCommandType::SetMesh) {
+				commands[i].ref += base;
+			}
+		}
+	}
+
+	void CommandBuffer::Clear() {
+		commands.clear();
+		meshes.clear();
+	}
+
+	void CommandBuffer::Swap(CommandBuffer& other) {
+		commands.swap(other.commands);
+		meshes.swap(other.meshes);
+	}
+
+	size_t CommandBuffer::Replay(IRenderer& renderer) const {
+		size_t failed = 0;
+		for (const RenderCommand& command : commands) {
+			bool ok = true;
+			switch (command.type) {
+				case RenderCommandType::SetMesh:
+					ok = renderer.UpdateMesh(command.slot, meshes[command.ref]);
+					break;
+				case RenderCommandType::SetTransform:
+					ok = renderer.UpdateTransform(command.slot, TransformOf(command));
+					break;
+				case RenderCommandType::UpdateRange:
+					ok = renderer.UpdateGeometryRange(command.slot, size_t(command.first), size_t(command.count));
+					break;
+				case RenderCommandType::DeleteMesh:
+					ok = renderer.DeleteMesh(command.slot);
+					break;
+				case RenderCommandType::SetLodBias:
+					renderer.lodBias = command.values[0];
+					break;
+				case RenderCommandType::SetSortDraws:
+					renderer.sortDraws = command.ref != 0;
+					break;
+				case RenderCommandType::SetDynamicResolution:
+					renderer.dynamicResolution = DynamicResolutionOf(command);
+					break;
+			}
+			if (!ok) {
+				failed++;
+			}
+		}
+		return failed;
+	}
+
+	std::string CommandBuffer::DumpCommand(size_t index) const {
+		const RenderCommand& c = commands[index];
+		char line[256];
+		switch (c.type) {
+			case RenderCommandType::SetMesh: {
+				const Mesh* mesh = meshes[c.ref].get();
+				snprintf(line, sizeof(line), "SetMesh %d mesh=%p geometry=%p", c.slot,
+					static_cast<const void*>(mesh), mesh ? static_cast<const void*>(mesh->geometry.get()) : nullptr);
+				break;
+			}
+			case RenderCommandType::SetTransform:
+				snprintf(line, sizeof(line), "SetTransform %d pos(%g %g %g) rot(%g %g %g) scale(%g %g %g)", c.slot,
+					c.values[0], c.values[1], c.values[2], c.values[3], c.values[4], c.values[5],
+					c.values[6], c.values[7], c.values[8]);
+				break;
+			case RenderCommandType::UpdateRange:
+				snprintf(line, sizeof(line), "UpdateRange %d first=%llu count=%llu", c.slot,
+					(unsigned long long)c.first, (unsigned long long)c.count);
+				break;
+			case RenderCommandType::SetLodBias:
+				snprintf(line, sizeof(line), "SetLodBias %g", c.values[0]);
+				break;
+			case RenderCommandType::SetSortDraws:
+				snprintf(line, sizeof(line), "SetSortDraws %s", c.ref ? "on" : "off");
+				break;
+			case RenderCommandType::SetDynamicResolution:
+				snprintf(line, sizeof(line), "SetDynamicResolution %s target=%gms scale=%g..%g", c.ref ? "on" : "off",
+					c.values[0], c.values[1], c.values[2]);
+				break;
+			default:
+				snprintf(line, sizeof(line), "%s %d", TypeName(c.type), c.slot);
+				break;
+		}
+		return line;
+	}
+
+	std::string CommandBuffer::Dump() const {
+		std::string out;
+		for (size_t i = 0; i < commands.size(); ++i) {
+			out += DumpCommand(i);
+			out += '\n';
+		}
+		return out;
+	}
+
+	std::vector<std::string> CommandBuffer::Diff(const CommandBuffer& a, const CommandBuffer& b, size_t maxLines) {
+		std::vector<std::string> lines;
+		size_t count = std::max(a.commands.size(), b.commands.size());
+		for (size_t i = 0; i < count && lines.size() < maxLines; ++i) {
+			bool inA = i < a.commands.size();
+			bool inB = i < b.commands.size();
+			if (inA && inB) {
+				const RenderCommand& ca = a.commands[i];
+				const RenderCommand& cb = b.commands[i];
+				// meshes compare by identity, not by their index in the side table
+				bool same = ca.type == cb.type && ca.slot == cb.slot && ca.first == cb.first && ca.count == cb.count
+					&& memcmp(ca.values, cb.values, sizeof(ca.values)) == 0
+					&& (ca.type == RenderCommandType::SetMesh ? a.meshes[ca.ref] == b.meshes[cb.ref] : ca.ref == cb.ref);
+				if (same) {
+					continue;
+				}
+			}
+			lines.push_back(std::to_string(i) + ": " + (inA ? a.DumpCommand(i) : "-") + " | " + (inB ? b.DumpCommand(i) : "-"));
+		}
+		return lines;
+	}
+
+	RenderCommands::ThreadBuffer& RenderCommands::Local() {
+		// registered on first use; the registry's reference outlives the
+		// thread so nothing it recorded before exiting is lost
+		thread_local std::shared_ptr<ThreadBuffer> local = [] {
+			auto buffer = std::make_shared<ThreadBuffer>();
+			std::lock_guard<std::mutex> lock(threadsMutex);
+			threads.push_back(buffer);
+			return buffer;
+		}();
+		return *local;
+	}
+
+	void RenderCommands::Flush(CommandBuffer& out) {
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (size_t i = 0; i < threads.size();) {
+			// a buffer only the registry holds belongs to a thread that has
+			// exited; checked before draining so nothing recorded is dropped
+			bool exited = threads[i].use_count() == 1;
+			{
+				std::lock_guard<std::mutex> threadLock(threads[i]->mutex);
+				out.Append(threads[i]->buffer);
+				threads[i]->buffer.Clear();
+			}
+			if (exited) {
+				threads.erase(threads.begin() + i);
+			} else {
+				++i;
+			}
+		}
+	}
+}
@@ -0,0 +1,109 @@
+// RenderCommands.h
+#pragma once
+
+#include "Mesh.h"
+#include "DynamicResolution.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace Renderer {
+	class IRenderer;
+
+	enum class RenderCommandType : uint8_t {
+		SetMesh,        // slot <- the buffer's mesh `ref` (UpdateMesh)
+		SetTransform,   // values = position, rotation, scale
+		UpdateRange,    // vertices [first, first + count)
+		DeleteMesh,
+		SetLodBias,     // values[0]
+		SetSortDraws,   // ref != 0
+		SetDynamicResolution,   // ref = enabled, values = target ms, min scale, max scale
+	};
+
+	// One recorded renderer call, plain data so streams can be copied,
+	// compared and written out as-is. The one argument that isn't POD, the
+	// mesh of a SetMesh, lives in the buffer's side table and is referenced
+	// by index.
+	struct RenderCommand {
+		RenderCommandType type  = RenderCommandType::SetTransform;
+		int32_t           slot  = -1;
+		uint32_t          ref   = 0;
+		uint64_t          first = 0;
+		uint64_t          count = 0;
+		float             values[9] = {};
+	};
+	static_assert(std::is_trivially_copyable<RenderCommand>::value, "RenderCommand must stay plain data");
+
+	class CommandBuffer {
+	public:
+		void SetMesh(int slot, std::shared_ptr<Mesh> mesh);
+		void SetTransform(int slot, const Transform& transform);
+		void UpdateRange(int slot, size_t first, size_t count);
+		void DeleteMesh(int slot);
+		void SetLodBias(float bias);
+		void SetSortDraws(bool sort);
+		void SetDynamicResolution(const DynamicResolutionSettings& settings);
+
+		// Appends `other`'s commands, remapping its mesh references.
+		void Append(const CommandBuffer& other);
+		void Clear();
+		void Swap(CommandBuffer& other);
+
+		bool   Empty() const { return commands.empty(); }
+		size_t Size() const { return commands.size(); }
+		const std::vector<RenderCommand>& Commands() const { return commands; }
+		// The mesh a SetMesh command refers to.
+		const std::shared_ptr<Mesh>& MeshOf(const RenderCommand& command) const { return meshes[command.ref]; }
+		static Transform TransformOf(const RenderCommand& command);
+		static DynamicResolutionSettings DynamicResolutionOf(const RenderCommand& command);
+
+		// Applies the commands to `renderer` in order; returns how many failed.
+		size_t Replay(IRenderer& renderer) const;
+
+		// One line per command, e.g. "SetTransform 3 pos(0 1 0) rot(0 90 0) scale(1 1 1)".
+		std::string Dump() const;
+
+		// "index: <a line> | <b line>" for the first `maxLines` commands that
+		// differ; empty when both streams are the same.
+		static std::vector<std::string> Diff(const CommandBuffer& a, const CommandBuffer& b, size_t maxLines = 16);
+
+	private:
+		std::vector<RenderCommand>         commands;
+		std::vector<std::shared_ptr<Mesh>> meshes;
+
+		std::string DumpCommand(size_t index) const;
+	};
+
+	// Per-thread command recording. Any thread may record into its own
+	// buffer without contending with the others; the render thread collects
+	// everything once per frame with Flush. Commands keep their order within
+	// a thread; threads are collected in the order they first recorded.
+	class RenderCommands {
+	public:
+		// Calls `record(CommandBuffer&)` on this thread's buffer.
+		template <typename Fn>
+		static void Record(Fn&& record) {
+			ThreadBuffer& local = Local();
+			std::lock_guard<std::mutex> lock(local.mutex);
+			record(local.buffer);
+		}
+
+		// Moves every thread's recorded commands to the end of `out`.
+		static void Flush(CommandBuffer& out);
+
+	private:
+		struct ThreadBuffer {
+			std::mutex    mutex;
+			CommandBuffer buffer;
+		};
+
+		static ThreadBuffer& Local();
+
+		static std::vector<std::shared_ptr<ThreadBuffer>> threads;
+		static std::mutex                                 threadsMutex;
+	};
+}
@@ -0,0 +1,62 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Renderer;
+
+namespace {
+	constexpr int      DepthBits    = 24;
+	constexpr int      BufferBits   = 24;
+	constexpr int      MaterialBits = 14;
+	constexpr uint32_t DepthMax     = (1u << DepthBits) - 1;
+}
+
+uint64_t RenderQueue::MakeKey(Pass pass, uint32_t material, uint32_t buffer, float depth01) {
+	float clamped = std::min(std::max(depth01, 0.0f), 1.0f);
+	uint32_t depth = static_cast<uint32_t>(std::lround(clamped * DepthMax));
+	if (pass == Pass_Transparent) {
+		depth = DepthMax - depth;
+	}
+
+	uint64_t key = uint64_t(pass & 3u);
+	key = (key << MaterialBits) | (material & ((1u << MaterialBits) - 1));
+	key = (key << BufferBits)   | (buffer & ((1u << BufferBits) - 1));
+	key = (key << DepthBits)    | depth;
+	return key;
+}
+
+void RenderQueue::Sort() {
+	const size_t count = items.size();
+	if (count < 64) {
+		// not worth clearing 8 KB of histograms for
+		std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+		return;
+	}
+
+	// all eight histograms in one read of the keys
+	uint32_t histogram[8][256] = {};
+	for (const Item& item : items) {
+		for (int b = 0; b < 8; ++b) {
+			histogram[b][(item.key >> (b * 8)) & 0xFF]++;
+		}
+	}
+
+	scratch.resize(count);
+	for (int b = 0; b < 8; ++b) {
+		uint32_t* counts = histogram[b];
+		if (counts[(items[0].key >> (b * 8)) & 0xFF] == count) {
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (int i = 0; i < 256; ++i) {
+			uint32_t c = counts[i];
+			counts[i] = offset;
+			offset += c;
+		}
+		for (const Item& item : items) {
+			scratch[counts[(item.key >> (b * 8)) & 0xFF]++] = item;
+		}
+		items.swap(scratch);
+	}
+}
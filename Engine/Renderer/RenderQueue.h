@@ -0,0 +1,44 @@
+// RenderQueue.h
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Renderer {
+
+// The frame's visible draws, ordered by a packed 64-bit key so draws that
+// share state end up next to each other. Key layout, high bits first:
+//   pass (2) | material (14) | geometry buffer (24) | depth (24)
+// Within one buffer opaque draws go front to back for early-Z; transparent
+// ones store the inverted depth and so go back to front.
+class RenderQueue {
+public:
+	enum Pass : uint32_t {
+		Pass_Opaque      = 0,
+		Pass_Transparent = 1,
+	};
+
+	struct Item {
+		uint64_t key;
+		uint32_t index;   // caller-defined, e.g. a mesh slot
+	};
+
+	// `depth01` is view depth over the far plane, clamped to 0..1.
+	static uint64_t MakeKey(Pass pass, uint32_t material, uint32_t buffer, float depth01);
+
+	void Clear() { items.clear(); }
+	void Push(uint64_t key, uint32_t index) { items.push_back({key, index}); }
+
+	// Stable LSD radix sort, a byte per pass; bytes that are the same in
+	// every key (most of the material field, today) cost no pass.
+	void Sort();
+
+	const std::vector<Item>& Items() const { return items; }
+
+private:
+	std::vector<Item> items;
+	std::vector<Item> scratch;
+};
+
+}
@@ -0,0 +1,161 @@
+#include "RenderThread.h"
+#include "../Core/Logger.h"
+#include <algorithm>
+#include <string>
+
+namespace Renderer {
+	RenderThread::~RenderThread() {
+		Stop();
+	}
+
+	void RenderThread::Start(IRenderer* target) {
+		if (thread.joinable()) {
+			return;
+		}
+		renderer = target;
+		camera.transform      = renderer->cam->transform;
+		camera.lookAtPosition = renderer->cam->lookAtPosition;
+		renderer->cam = &camera;
+		stopping = false;
+		thread = std::thread(&RenderThread::Run, this);
+	}
+
+	void RenderThread::Stop() {
+		if (!thread.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			stopping = true;
+		}
+		wake.notify_one();
+		thread.join();
+		// the copies hold the renderer's meshes; it drops its own buffers later
+		meshes.clear();
+	}
+
+	FrameSnapshot& RenderThread::Back() {
+		FrameSnapshot& snapshot = snapshots[back];
+		if (!backStale) {
+			snapshot.commands.Clear();
+			snapshot.edits.clear();
+		}
+		return snapshot;
+	}
+
+	void RenderThread::Publish() {
+		uint32_t previous = middle.exchange(back | Fresh, std::memory_order_acq_rel);
+		back      = previous & IndexMask;
+		// still fresh means the render thread never took it: keep its
+		// commands and edits so the next frame replays them
+		backStale = (previous & Fresh) != 0;
+		{
+			// empty lock so the notify can't slip between the render
+			// thread's check and its wait
+			std::lock_guard<std::mutex> lock(wakeMutex);
+		}
+		wake.notify_one();
+	}
+
+	FrameStats RenderThread::GetFrameStats() {
+		std::lock_guard<std::mutex> lock(statsMutex);
+		return frameStats;
+	}
+
+	LodStats RenderThread::GetLodStats() {
+		std::lock_guard<std::mutex> lock(statsMutex);
+		return lodStats;
+	}
+
+	void RenderThread::GetResolutionHistory(std::vector<DynamicResolution::Sample>& out) {
+		std::lock_guard<std::mutex> lock(statsMutex);
+		out = resolutionHistory;
+	}
+
+	void RenderThread::Run() {
+		if (!renderer->MakeCurrent(true)) {
+			Logger::Error("Render thread could not take the renderer's context.");
+			return;
+		}
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				wake.wait(lock, [this] { return stopping || (middle.load(std::memory_order_acquire) & Fresh); });
+				if (stopping) {
+					break;
+				}
+			}
+			front = middle.exchange(front, std::memory_order_acq_rel) & IndexMask;
+			Apply(snapshots[front]);
+			renderer->RenderFrame();
+			rendered.fetch_add(1, std::memory_order_relaxed);
+
+			std::lock_guard<std::mutex> lock(statsMutex);
+			frameStats = renderer->frameStats;
+			lodStats   = renderer->lodStats;
+			renderer->resolutionController.CopyHistory(resolutionHistory);
+		}
+		renderer->MakeCurrent(false);
+	}
+
+	// Brings the renderer's copies in line with the snapshot. The renderer
+	// only ever sees meshes this thread owns, so the simulation is free to
+	// change its own while this frame draws.
+	void RenderThread::Apply(FrameSnapshot& snapshot) {
+		camera.transform      = snapshot.camera;
+		camera.lookAtPosition = snapshot.cameraLookAt;
+
+		size_t count = std::max(meshes.size(), snapshot.slots.size());
+		meshes.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			std::shared_ptr<Mesh>& mesh = meshes[i];
+			int slot = static_cast<int>(i);
+			if (i >= snapshot.slots.size() || !snapshot.slots[i].geometry) {
+				if (mesh) {
+					renderer->DeleteMesh(slot);
+					mesh = nullptr;
+				}
+				continue;
+			}
+
+			const SlotSnapshot& source = snapshot.slots[i];
+			if (!mesh || mesh->geometry != source.geometry || mesh->is_static != source.is_static
+				|| mesh->is_castable != source.is_castable || mesh->texture != source.texture) {
+				mesh = std::make_shared<Mesh>(source.geometry);
+				mesh->transform   = source.transform;
+				mesh->is_castable = source.is_castable;
+				mesh->is_static   = source.is_static;
+				mesh->texture     = source.texture;
+				renderer->UpdateMesh(slot, mesh);
+			} else if (mesh->transform != source.transform) {
+				renderer->UpdateTransform(slot, source.transform);
+			}
+		}
+		meshes.resize(snapshot.slots.size());
+
+		// the snapshot gets the renderer's old list, to be refilled next time
+		renderer->debugDraw.Swap(snapshot.debugDraw);
+
+		// only this thread touches the copies, and the main thread only
+		// hands their pointers around, so they are written here unlocked
+		for (const GeometryEdit& edit : snapshot.edits) {
+			MeshGeometry& target = *edit.target;
+			size_t count = edit.vertices.size() + edit.packed.size();
+			if (target.IsPacked() != !edit.packed.empty() || edit.first + count > target.VertexCount()) {
+				continue;
+			}
+			std::copy(edit.vertices.begin(), edit.vertices.end(), target.vertices.begin() + edit.first);
+			std::copy(edit.packed.begin(), edit.packed.end(), target.packed.begin() + edit.first);
+			for (size_t v = edit.first; v < edit.first + count; ++v) {
+				glm::vec3 position = target.Position(uint32_t(v));
+				target.boundsMin = glm::min(target.boundsMin, position);
+				target.boundsMax = glm::max(target.boundsMax, position);
+			}
+		}
+
+		size_t failed = snapshot.commands.Replay(*renderer);
+		if (failed) {
+			Logger::Warn(std::to_string(failed) + " render commands failed");
+		}
+	}
+}
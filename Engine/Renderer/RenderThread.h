@@ -0,0 +1,108 @@
+// RenderThread.h
+#pragma once
+
+#include "IRenderer.h"
+#include "RenderCommands.h"
+#include "Camera.h"
+#include "Mesh.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace Renderer {
+	// What one slot looked like when the frame was taken.
+	struct SlotSnapshot {
+		std::shared_ptr<const MeshGeometry> geometry;   // null for an empty slot
+		Transform transform;
+		bool      is_castable = true;
+		bool      is_static   = false;
+		std::shared_ptr<Texture> texture;
+	};
+
+	// Vertices the game edited in place, copied out of its geometry. The
+	// render thread writes them into `target`, its own copy of that
+	// geometry, before the frame's UpdateRange commands upload them.
+	struct GeometryEdit {
+		std::shared_ptr<MeshGeometry> target;
+		size_t                        first = 0;
+		std::vector<Vertex>           vertices;   // whichever layout the
+		std::vector<PackedVertex>     packed;     // geometry has
+	};
+
+	// Everything the renderer needs for one frame, copied out of the
+	// simulation so the render thread never reads game-owned state.
+	struct FrameSnapshot {
+		uint64_t                  frame = 0;
+		Transform                 camera;
+		glm::vec3                 cameraLookAt = glm::vec3(0.0f);
+		std::vector<SlotSnapshot> slots;
+		// settings and UpdateRange uploads; slot changes are carried by `slots`
+		CommandBuffer             commands;
+		std::vector<GeometryEdit> edits;   // in order, before `commands`
+		// only the newest frame's primitives count, skipped frames' are dropped
+		DebugDrawList             debugDraw;
+	};
+
+	// Drives an IRenderer from its own thread, one frame behind the
+	// simulation. Snapshots are handed over through a triple buffer: the
+	// main thread fills the back snapshot and publishes it with a single
+	// atomic exchange, the render thread takes whichever snapshot is newest,
+	// and neither ever waits on the other. Frames the render thread was too
+	// slow to see are skipped, but their commands are carried forward.
+	class RenderThread {
+	public:
+		~RenderThread();
+
+		// Moves `renderer` onto the new thread; its context must already be
+		// released by the caller (IRenderer::MakeCurrent(false)). The renderer
+		// draws from the thread's own copy of the camera from now on.
+		void Start(IRenderer* renderer);
+		// Joins the thread, which releases the context on the way out.
+		void Stop();
+		bool Running() const { return thread.joinable(); }
+
+		// Main thread only: the snapshot to fill for the next frame. Its
+		// commands and edits may hold a skipped frame's; append, don't replace.
+		FrameSnapshot& Back();
+		void Publish();
+
+		uint64_t   FramesRendered() const { return rendered.load(std::memory_order_relaxed); }
+		FrameStats GetFrameStats();
+		LodStats   GetLodStats();
+		void       GetResolutionHistory(std::vector<DynamicResolution::Sample>& out);
+
+	private:
+		static const uint32_t IndexMask = 0x3;
+		static const uint32_t Fresh     = 0x4;   // the middle snapshot hasn't been taken yet
+
+		void Run();
+		void Apply(FrameSnapshot& snapshot);
+
+		FrameSnapshot         snapshots[3];
+		std::atomic<uint32_t> middle{1};
+		uint32_t              back      = 0;       // main thread
+		bool                  backStale = false;   // main thread: back was never rendered
+		uint32_t              front     = 2;       // render thread
+
+		std::thread             thread;
+		std::atomic<bool>       stopping{false};
+		std::atomic<uint64_t>   rendered{0};
+		// only parks the render thread while there's nothing new to draw
+		std::mutex              wakeMutex;
+		std::condition_variable wake;
+
+		// render thread only
+		IRenderer*                         renderer = nullptr;
+		Camera                             camera;
+		std::vector<std::shared_ptr<Mesh>> meshes;
+
+		std::mutex statsMutex;
+		FrameStats frameStats;
+		LodStats   lodStats;
+		std::vector<DynamicResolution::Sample> resolutionHistory;
+	};
+}
@@ -1,5 +1,6 @@
 // RendererDX9.cpp
 #include "RendererDX9.h"
+#include "TextureManager.h"
 #include "../Core/Logger.h"
 #include <GLFW/glfw3.h>               // for timing
 #define GLM_ENABLE_EXPERIMENTAL
@@ -7,7 +8,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 #include <windows.h>
+#include <algorithm>
 #include <vector>
+#include <cmath>
 #include "../Core/stb_impl.h"
 
 using namespace Renderer;
@@ -26,6 +29,17 @@ static SkyboxVertex skyboxVertices[36];
 static IDirect3DVertexBuffer9* skyboxVB = nullptr;
 static IDirect3DTexture9* skyboxTexture = nullptr;
 
+static const float NearPlane = 0.1f;
+static const float FarPlane  = 100.0f;
+
+// render queue items with this bit set index a static batch, not a mesh slot
+static const uint32_t BatchDraw = 0x80000000u;
+
+// material field of a draw's sort key: its texture, if it draws with one
+static uint32_t MaterialKey(const Mesh& mesh) {
+	return (mesh.texture && mesh.texture->Ready()) ? mesh.texture->Id() : 0;
+}
+
 void CreateSkyboxVertices() {
 	// Cube positions with corresponding texture coordinates
 	struct VertexData {
@@ -428,6 +442,65 @@ bool RendererDX9::Init(Camera* c, Runtime::Runtime *r) {
 	return true;
 }
 
+//------------------------------------------------------------------------
+uintptr_t RendererDX9::CreateTexture(int width, int height, int mipCount, PixelFormat format) {
+	D3DFORMAT d3dFormat;
+	switch (format) {
+	case PixelFormat::RGBA8: d3dFormat = D3DFMT_A8R8G8B8; break;
+	case PixelFormat::BC1:   d3dFormat = D3DFMT_DXT1;     break;
+	case PixelFormat::BC3:   d3dFormat = D3DFMT_DXT5;     break;
+	default:                 return 0;
+	}
+	IDirect3DTexture9* texture = nullptr;
+	if (FAILED(d3dDevice->CreateTexture(width, height, mipCount, 0, d3dFormat,
+										D3DPOOL_MANAGED, &texture, nullptr))) {
+		return 0;
+	}
+	return reinterpret_cast<uintptr_t>(texture);
+}
+
+bool RendererDX9::UploadTextureLevel(uintptr_t texture, int level, int width, int height, const uint8_t* data, size_t size) {
+	IDirect3DTexture9* tex = reinterpret_cast<IDirect3DTexture9*>(texture);
+	D3DSURFACE_DESC desc;
+	D3DLOCKED_RECT rect;
+	if (FAILED(tex->GetLevelDesc(level, &desc)) || FAILED(tex->LockRect(level, &rect, nullptr, 0))) {
+		return false;
+	}
+	// never write past the level as the device sized it, whatever `width`
+	// and `height` claim
+	if (desc.Format == D3DFMT_DXT1 || desc.Format == D3DFMT_DXT5) {
+		// a row of 4x4 blocks at a time; Pitch is per block row
+		int    blockRows = (height + 3) / 4;
+		size_t rowBytes  = size / blockRows;
+		size_t maxBytes  = size_t((desc.Width + 3) / 4) * (desc.Format == D3DFMT_DXT1 ? 8 : 16);
+		size_t copyBytes = (std::min)(rowBytes, (std::min)(maxBytes, size_t(rect.Pitch)));
+		int    copyRows  = (std::min)(blockRows, int((desc.Height + 3) / 4));
+		for (int y = 0; y < copyRows; ++y) {
+			memcpy(static_cast<uint8_t*>(rect.pBits) + size_t(y) * rect.Pitch, data + y * rowBytes, copyBytes);
+		}
+	} else if (size >= size_t(width) * height * 4) {
+		// RGBA in, BGRA (D3DFMT_A8R8G8B8 in memory) out
+		int copyWidth  = (std::min)(width, int(desc.Width));
+		int copyHeight = (std::min)(height, int(desc.Height));
+		for (int y = 0; y < copyHeight; ++y) {
+			const uint8_t* src = data + size_t(y) * width * 4;
+			uint8_t*       dst = static_cast<uint8_t*>(rect.pBits) + size_t(y) * rect.Pitch;
+			for (int x = 0; x < copyWidth; ++x, src += 4, dst += 4) {
+				dst[0] = src[2];
+				dst[1] = src[1];
+				dst[2] = src[0];
+				dst[3] = src[3];
+			}
+		}
+	}
+	tex->UnlockRect(level);
+	return true;
+}
+
+void RendererDX9::DeleteTexture(uintptr_t texture) {
+	reinterpret_cast<IDirect3DTexture9*>(texture)->Release();
+}
+
 //------------------------------------------------------------------------
 void RendererDX9::ResetDevice() {
 	pp.BackBufferWidth  = width;
@@ -484,6 +557,34 @@ int RendererDX9::AddMesh(std::shared_ptr<Mesh> mesh) {
 	return indx;
 }
 
+// Expands vertices [first, first + count) of `geo` into DXVertex.
+static void WriteVertices(const MeshGeometry& geo, size_t first, size_t count, DXVertex* verts) {
+	if (geo.IsPacked()) {
+		// the fixed-function pipeline only takes float positions, so packed
+		// meshes are expanded here and only save memory on the CPU side
+		for (size_t i = 0; i < count; i++) {
+			glm::vec3 p = geo.Position(first + i);
+			glm::vec3 n = geo.Normal(first + i);
+			glm::vec2 t = geo.Texcoord(first + i);
+			verts[i] = { p.x, p.y, p.z, n.x, n.y, n.z, t.x, t.y };
+		}
+	} else {
+		for (size_t i = 0; i < count; i++) {
+			const auto& v = geo.vertices[first + i];
+			verts[i].x = v.position.x;
+			verts[i].y = v.position.y;
+			verts[i].z = v.position.z;
+			
+			verts[i].nx = v.normal.x;
+			verts[i].ny = v.normal.y;
+			verts[i].nz = v.normal.z;
+			
+			verts[i].u = v.texcoord.x;
+			verts[i].v = v.texcoord.y;
+		}
+	}
+}
+
 bool RendererDX9::UpdateMesh(int indx, std::shared_ptr<Mesh> mesh) {
 	// Ensure the vectors are large enough
 	if (indx >= meshes.size()) {
@@ -493,117 +594,171 @@ bool RendererDX9::UpdateMesh(int indx, std::shared_ptr<Mesh> mesh) {
 	
 	meshes[indx] = mesh;
 	
-	int vertexCount = mesh->vertices.size();
-	DX9MeshData& meshData = meshBuffers[indx];
-	
-	// Check if we need to recreate the vertex buffer
-	bool needNewVertexBuffer = false;
-	if (!meshData.vertexBuffer) {
-		needNewVertexBuffer = true;
-	} else if (meshData.vertexCount != vertexCount) {
-		// Size changed, need new buffer
-		needNewVertexBuffer = true;
-		meshData.vertexBuffer->Release();
-		meshData.vertexBuffer = nullptr;
-	}
-	
-	// Create or reuse vertex buffer
-	if (needNewVertexBuffer) {
-		HRESULT hr = d3dDevice->CreateVertexBuffer(
-			vertexCount * sizeof(DXVertex),
-			D3DUSAGE_WRITEONLY,
-			D3DFVF_DXVERTEX,
-			D3DPOOL_MANAGED,
-			&meshData.vertexBuffer,
-			nullptr
-		);
-		
-		if (FAILED(hr)) {
-			Logger::Error("Failed to create vertex buffer for mesh");
-			return false;
+	if (!mesh || !mesh->geometry) {
+		batcher.Remove(indx);
+		meshBuffers[indx] = nullptr;
+		return mesh != nullptr;
+	}
+	
+	// static meshes are drawn from their batch, not from their own buffers
+	if (batcher.Update(indx, mesh)) {
+		meshBuffers[indx] = nullptr;
+		return true;
+	}
+	
+	// Transform-only updates keep the slot's buffers untouched
+	if (meshBuffers[indx] && meshBuffers[indx]->source == mesh->geometry) {
+		return true;
+	}
+	
+	meshBuffers[indx] = BuffersFor(mesh->geometry);
+	return meshBuffers[indx] != nullptr;
+}
+
+// Returns the buffers for `geometry`, uploading it only if no other mesh
+// slot already holds them.
+std::shared_ptr<DX9MeshData> RendererDX9::BuffersFor(const std::shared_ptr<const MeshGeometry>& geometry) {
+	auto found = geometryBuffers.find(geometry.get());
+	if (found != geometryBuffers.end()) {
+		if (auto shared = found->second.lock()) {
+			return shared;
 		}
+		geometryBuffers.erase(found);
+	}
+	
+	const MeshGeometry& geo = *geometry;
+	auto meshData = std::make_shared<DX9MeshData>();
+	int vertexCount = geo.VertexCount();
+	
+	HRESULT hr = d3dDevice->CreateVertexBuffer(
+		vertexCount * sizeof(DXVertex),
+		D3DUSAGE_WRITEONLY,
+		D3DFVF_DXVERTEX,
+		D3DPOOL_MANAGED,
+		&meshData->vertexBuffer,
+		nullptr
+	);
+	
+	if (FAILED(hr)) {
+		Logger::Error("Failed to create vertex buffer for mesh");
+		return nullptr;
 	}
 	
-	// Always update the vertex data (even if buffer was reused)
 	DXVertex* verts;
-	meshData.vertexBuffer->Lock(0, 0, (void**)&verts, 0);
-	for (int i = 0; i < vertexCount; i++) {
-		const auto& v = mesh->vertices[i];
-		verts[i].x = v.position.x;
-		verts[i].y = v.position.y;
-		verts[i].z = v.position.z;
-		
-		verts[i].nx = v.normal.x;
-		verts[i].ny = v.normal.y;
-		verts[i].nz = v.normal.z;  // Fix: was nx again
-		
-		// Add UV coordinates if you have them:
-		// verts[i].u = v.uv.x;
-		// verts[i].v = v.uv.y;
+	meshData->vertexBuffer->Lock(0, 0, (void**)&verts, 0);
+	WriteVertices(geo, 0, vertexCount, verts);
+	meshData->vertexBuffer->Unlock();
+	
+	// Welded meshes index into the unique vertices; 16-bit indices whenever they fit
+	int indexCount = 0;
+	for (size_t level = 0; level < geo.LodCount(); level++) {
+		meshData->lodStart[level] = indexCount;
+		meshData->lodIndexCount[level] = geo.LodIndices(level).size();
+		indexCount += meshData->lodIndexCount[level];
 	}
-	meshData.vertexBuffer->Unlock();
+	meshData->lodLevels = geo.LodCount();
+	bool index32 = vertexCount > 0xFFFF;
 	
-	// Check if we need to recreate the index buffer
-	bool needNewIndexBuffer = false;
-	if (!meshData.indexBuffer) {
-		needNewIndexBuffer = true;
-	} else if (meshData.vertexCount != vertexCount) {
-		// Size changed, need new buffer
-		needNewIndexBuffer = true;
-		meshData.indexBuffer->Release();
-		meshData.indexBuffer = nullptr;
-	}
-	
-	// Create or reuse index buffer
-	if (needNewIndexBuffer) {
-		HRESULT hr = d3dDevice->CreateIndexBuffer(
-			vertexCount * sizeof(WORD),
-			D3DUSAGE_WRITEONLY,
-			D3DFMT_INDEX16,
-			D3DPOOL_MANAGED,
-			&meshData.indexBuffer,
-			nullptr
-		);
-		
-		if (FAILED(hr)) {
-			Logger::Error("Failed to create index buffer for mesh");
-			return false;
-		}
-		
-		// Fill index buffer with sequential indices (only when creating new buffer)
-		WORD* indices;
-		meshData.indexBuffer->Lock(0, 0, (void**)&indices, 0);
-		for (int i = 0; i < vertexCount; i++) {
-			indices[i] = i;
+	hr = d3dDevice->CreateIndexBuffer(
+		indexCount * (index32 ? sizeof(DWORD) : sizeof(WORD)),
+		D3DUSAGE_WRITEONLY,
+		index32 ? D3DFMT_INDEX32 : D3DFMT_INDEX16,
+		D3DPOOL_MANAGED,
+		&meshData->indexBuffer,
+		nullptr
+	);
+	
+	if (FAILED(hr)) {
+		Logger::Error("Failed to create index buffer for mesh");
+		return nullptr;
+	}
+	
+	void* dst;
+	meshData->indexBuffer->Lock(0, 0, &dst, 0);
+	for (int level = 0; level < meshData->lodLevels; level++) {
+		const std::vector<uint32_t>& lodIndices = geo.LodIndices(level);
+		if (index32) {
+			memcpy(static_cast<DWORD*>(dst) + meshData->lodStart[level], lodIndices.data(), lodIndices.size() * sizeof(DWORD));
+		} else {
+			WORD* indices = static_cast<WORD*>(dst) + meshData->lodStart[level];
+			for (size_t i = 0; i < lodIndices.size(); i++) {
+				indices[i] = static_cast<WORD>(lodIndices[i]);
+			}
 		}
-		meshData.indexBuffer->Unlock();
 	}
+	meshData->indexBuffer->Unlock();
+	
+	static uint32_t nextId = 0;
+	meshData->id = ++nextId;
+	meshData->source = geometry;
+	meshData->vertexCount = vertexCount;
+	meshData->indexCount = indexCount;
+	meshData->index32 = index32;
+	meshData->triangleCount = meshData->lodIndexCount[0] / 3;
 	
-	// Update metadata
-	meshData.vertexCount = vertexCount;
-	meshData.triangleCount = vertexCount / 3;
+	geometryBuffers[geometry.get()] = meshData;
+	return meshData;
+}
+
+bool RendererDX9::UpdateTransform(int indx, const Transform& transform) {
+	if (indx < 0 || indx >= meshes.size() || !meshes[indx]) {
+		return false;
+	}
 	
+	// the world matrix is rebuilt from the transform every frame; nothing to upload
+	// unless the mesh is static, in which case only its batches re-merge
+	meshes[indx]->transform = transform;
+	batcher.Update(indx, meshes[indx]);
 	return true;
 }
 
-bool RendererDX9::DeleteMesh(int indx) {
-	// Check if index is valid
-	if (indx < 0 || indx >= meshBuffers.size()) {
-		Logger::Error("Invalid mesh index for deletion");
+bool RendererDX9::UpdateGeometryRange(int indx, size_t first, size_t count) {
+	if (indx < 0 || indx >= meshes.size() || !meshes[indx] || !meshes[indx]->geometry) {
 		return false;
 	}
 	
-	// Get reference to the mesh data
-	DX9MeshData& meshData = meshBuffers[indx];
+	if (batcher.IsBatched(indx)) {
+		batcher.Invalidate(indx);
+		return true;
+	}
 	
-	// Release buffers
-	if (meshData.vertexBuffer) {
-		meshData.vertexBuffer->Release();
+	// buffers that are missing or stale get a full upload instead
+	if (indx >= meshBuffers.size() || !meshBuffers[indx] || meshBuffers[indx]->source != meshes[indx]->geometry) {
+		return UpdateMesh(indx, meshes[indx]);
+	}
+	
+	DX9MeshData& meshData = *meshBuffers[indx];
+	if (first + count > size_t(meshData.vertexCount) || first + count > meshData.source->VertexCount()) {
+		Logger::Error("Mesh vertex range out of bounds");
+		return false;
+	}
+	if (count == 0) {
+		return true;
 	}
-	if (meshData.indexBuffer) {
-		meshData.indexBuffer->Release();
+	
+	// lock just the changed vertices
+	DXVertex* verts;
+	if (FAILED(meshData.vertexBuffer->Lock(UINT(first * sizeof(DXVertex)), UINT(count * sizeof(DXVertex)), (void**)&verts, 0))) {
+		Logger::Error("Failed to lock vertex buffer for mesh");
+		return false;
+	}
+	WriteVertices(*meshData.source, first, count, verts);
+	meshData.vertexBuffer->Unlock();
+	// moved vertices may leave the bounds the culler has
+	culler.Extend(*meshData.source, first, count);
+	return true;
+}
+
+bool RendererDX9::DeleteMesh(int indx) {
+	// Check if index is valid
+	if (indx < 0 || indx >= meshBuffers.size()) {
+		Logger::Error("Invalid mesh index for deletion");
+		return false;
 	}
 	
+	// The buffers go away with the last slot that shares them
+	batcher.Remove(indx);
+	meshBuffers[indx] = nullptr;
 	meshes[indx] = nullptr;
 	
 	return true;
@@ -614,8 +769,12 @@ bool RendererDX9::DeleteMesh(int indx) {
 bool RendererDX9::SetMeshes(std::vector<std::shared_ptr<Mesh>> msh) {
 	meshes = std::move(msh);
 	
+	// hold on to the old buffers until the new list has picked up the ones it shares
+	std::vector<std::shared_ptr<DX9MeshData>> previous = std::move(meshBuffers);
 	meshBuffers.clear();
 	meshBuffers.resize(meshes.size());
+	batcher.Clear();
+	batchBuffers.clear();
 	
 	for (int meshi = 0; meshi < meshes.size(); meshi++) {
 		const auto& mesh = meshes[meshi];
@@ -663,8 +822,9 @@ void Renderer::RendererDX9::setSize(int newWidth, int newHeight) {
 	ResetDevice();
 }
 
-Renderer::ImageData Renderer::RendererDX9::CaptureFrame() {
-	return ImageData();
+const Renderer::ImageData& Renderer::RendererDX9::CaptureFrame() {
+	static const ImageData none;
+	return none;
 }
 
 void RendererDX9::RenderSkybox() {
@@ -728,9 +888,72 @@ void RendererDX9::RenderSkybox() {
 	d3dDevice->SetFVF(D3DFVF_DXVERTEX);
 }
 
+// Debug primitives, unlit in their own colours: the depth-tested bucket,
+// then the overlay. DrawPrimitiveUP streams each list through the
+// runtime's own transient vertex buffer, which survives device resets.
+uint32_t RendererDX9::DrawDebug(const DebugDrawList& list) {
+	if (list.VertexCount() == 0) return 0;
+
+	const std::vector<DebugVertex>* parts[] = {
+		&list.Lines(DebugDrawList::Depth),   &list.Triangles(DebugDrawList::Depth),
+		&list.Lines(DebugDrawList::Overlay), &list.Triangles(DebugDrawList::Overlay),
+	};
+	// RGBA bytes to ARGB, once for the whole list
+	debugVertices.clear();
+	for (const auto* part : parts) {
+		for (const DebugVertex& v : *part) {
+			uint32_t c = v.color;
+			debugVertices.push_back({v.position.x, v.position.y, v.position.z,
+				D3DCOLOR_ARGB(c >> 24, c & 0xFF, (c >> 8) & 0xFF, (c >> 16) & 0xFF)});
+		}
+	}
+
+	DWORD oldZEnable, oldZWrite, oldLighting, oldCullMode, oldColorOp, oldColorArg1;
+	d3dDevice->GetRenderState(D3DRS_ZENABLE, &oldZEnable);
+	d3dDevice->GetRenderState(D3DRS_ZWRITEENABLE, &oldZWrite);
+	d3dDevice->GetRenderState(D3DRS_LIGHTING, &oldLighting);
+	d3dDevice->GetRenderState(D3DRS_CULLMODE, &oldCullMode);
+	d3dDevice->GetTextureStageState(0, D3DTSS_COLOROP, &oldColorOp);
+	d3dDevice->GetTextureStageState(0, D3DTSS_COLORARG1, &oldColorArg1);
+
+	d3dDevice->SetRenderState(D3DRS_ZWRITEENABLE, FALSE);
+	d3dDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	d3dDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	d3dDevice->SetTexture(0, nullptr);
+	d3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+	d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_DIFFUSE);
+	D3DMATRIX identity = ToD3D(glm::mat4(1.0f));
+	d3dDevice->SetTransform(D3DTS_WORLD, &identity);
+	d3dDevice->SetFVF(D3DFVF_DXDEBUGVERTEX);
+
+	uint32_t draws = 0;
+	size_t   first = 0;
+	for (int i = 0; i < 4; ++i) {
+		size_t count = parts[i]->size();
+		bool triangles = (i % 2) != 0;
+		if (count) {
+			d3dDevice->SetRenderState(D3DRS_ZENABLE, i < 2 ? D3DZB_TRUE : D3DZB_FALSE);
+			d3dDevice->DrawPrimitiveUP(triangles ? D3DPT_TRIANGLELIST : D3DPT_LINELIST,
+				UINT(count / (triangles ? 3 : 2)), &debugVertices[first], sizeof(DXDebugVertex));
+			draws++;
+		}
+		first += count;
+	}
+
+	d3dDevice->SetRenderState(D3DRS_ZENABLE, oldZEnable);
+	d3dDevice->SetRenderState(D3DRS_ZWRITEENABLE, oldZWrite);
+	d3dDevice->SetRenderState(D3DRS_LIGHTING, oldLighting);
+	d3dDevice->SetRenderState(D3DRS_CULLMODE, oldCullMode);
+	d3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, oldColorOp);
+	d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, oldColorArg1);
+	d3dDevice->SetFVF(D3DFVF_DXVERTEX);
+	return draws;
+}
+
 //------------------------------------------------------------------------
 void RendererDX9::RenderFrame() {
 	if (!d3dDevice) return;
+	double frameStart = glfwGetTime();
 
 	// pump Win32 messages - yeah! pump those messages!
 	MSG msg;
@@ -748,6 +971,9 @@ void RendererDX9::RenderFrame() {
 	HandleInputDX9(dt);
 	cam->updateForFrame();
 
+	// finished texture loads, a budgeted slice per frame
+	TextureManager::ProcessUploads(*this);
+
 	// clear & begin scene
 	d3dDevice->SetRenderState(D3DRS_AMBIENT, D3DCOLOR_XRGB(25,25,25));
 	d3dDevice->Clear(0, nullptr, D3DCLEAR_TARGET|D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(20,20,50), 1.0f, 0);
@@ -755,7 +981,7 @@ void RendererDX9::RenderFrame() {
 	
 	// projection
 	float aspect = static_cast<float>(width) / static_cast<float>(height);
-	glm::mat4 projGL = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
+	glm::mat4 projGL = glm::perspective(glm::radians(Camera::FieldOfView), aspect, NearPlane, FarPlane);
 	auto mtr = ToD3D(projGL);
 	d3dDevice->SetTransform(D3DTS_PROJECTION, &mtr);
 
@@ -808,40 +1034,141 @@ void RendererDX9::RenderFrame() {
 	d3dDevice->LightEnable(0, TRUE);
 	d3dDevice->SetRenderState(D3DRS_LIGHTING, TRUE);
 	
-	for (size_t i = 0; i < meshes.size() && i < meshBuffers.size(); i++) {
-		const auto& mesh = meshes[i];
-		
-		if (!mesh) {
+	// pixels per world unit at distance 1, for picking LODs
+	float lodPixelScale = height / (2.0f * tanf(glm::radians(Camera::FieldOfView) * 0.5f));
+	float lodMaxError   = LodPixelError * exp2f(lodBias);
+	lodStats = LodStats();
+	frameStats = FrameStats();
+	
+	// D3D clips depth to 0..w, so the near plane comes from the z row alone
+	culler.Resize(meshes.size());
+	for (size_t i = 0; i < meshes.size(); i++) {
+		if (batcher.Update(i, meshes[i])) {
+			if (i < meshBuffers.size()) meshBuffers[i] = nullptr;
+			culler.Update(i, nullptr, Transform());
 			continue;
 		}
+		bool drawable = meshes[i] && i < meshBuffers.size() && meshBuffers[i];
+		culler.Update(i, drawable ? meshBuffers[i]->source.get() : nullptr, drawable ? meshes[i]->transform : Transform());
+	}
+	
+	// only the cells a static mesh moved in or out of are re-merged
+	batcher.Rebuild();
+	const std::vector<StaticBatcher::Batch>& batches = batcher.Batches();
+	batchBuffers.resize(batches.size());
+	batchCuller.Resize(batches.size());
+	for (size_t b = 0; b < batches.size(); b++) {
+		const auto& batch = batches[b].mesh;
+		if (!batch) {
+			batchBuffers[b] = nullptr;
+		} else if (!batchBuffers[b] || batchBuffers[b]->source != batch->geometry) {
+			batchBuffers[b] = BuffersFor(batch->geometry);
+		}
+		bool drawable = batch && batchBuffers[b];
+		batchCuller.Update(b, drawable ? batch->geometry.get() : nullptr, drawable ? batch->transform : Transform());
+	}
+	
+	FrustumCuller::Planes planes = FrustumCuller::ExtractPlanes(projGL * viewGL, true);
+	visibleMeshes.clear();
+	culler.Cull(planes, visibleMeshes);
+	visibleBatches.clear();
+	batchCuller.Cull(planes, visibleBatches);
+	frameStats.meshesTested = culler.Tested() + batchCuller.Tested();
+	frameStats.meshesCulled = culler.Culled() + batchCuller.Culled();
+	
+	// key every visible draw by pass, texture, buffer and depth, then sort
+	glm::vec3 viewPos     = cam->transform.position;
+	glm::vec3 viewForward = glm::normalize(cam->lookAtPosition - cam->transform.position);
+	renderQueue.Clear();
+	for (uint32_t i : visibleMeshes) {
+		float depth = glm::dot(culler.Center(i) - viewPos, viewForward) / FarPlane;
+		renderQueue.Push(RenderQueue::MakeKey(RenderQueue::Pass_Opaque, MaterialKey(*meshes[i]), meshBuffers[i]->id, depth), i);
+	}
+	for (uint32_t b : visibleBatches) {
+		float depth = glm::dot(batchCuller.Center(b) - viewPos, viewForward) / FarPlane;
+		renderQueue.Push(RenderQueue::MakeKey(RenderQueue::Pass_Opaque, MaterialKey(*batches[b].mesh), batchBuffers[b]->id, depth), b | BatchDraw);
+	}
+	if (sortDraws) {
+		renderQueue.Sort();
+	}
+	
+	// textured draws modulate the lit colour by the texture; the untextured
+	// ones keep whatever the stage was set to
+	DWORD oldColorOp, oldColorArg1, oldColorArg2;
+	d3dDevice->GetTextureStageState(0, D3DTSS_COLOROP, &oldColorOp);
+	d3dDevice->GetTextureStageState(0, D3DTSS_COLORARG1, &oldColorArg1);
+	d3dDevice->GetTextureStageState(0, D3DTSS_COLORARG2, &oldColorArg2);
+	d3dDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	d3dDevice->SetSamplerState(0, D3DSAMP_ADDRESSU, D3DTADDRESS_WRAP);
+	d3dDevice->SetSamplerState(0, D3DSAMP_ADDRESSV, D3DTADDRESS_WRAP);
+	IDirect3DTexture9* boundTexture = nullptr;
+
+	const DX9MeshData* bound = nullptr;
+	for (const RenderQueue::Item& item : renderQueue.Items()) {
+		bool isBatch = (item.index & BatchDraw) != 0;
+		uint32_t i   = item.index & ~BatchDraw;
+		const auto& mesh = isBatch ? batches[i].mesh : meshes[i];
+		const DX9MeshData& meshData = isBatch ? *batchBuffers[i] : *meshBuffers[i];
 		
-		const auto& meshData = meshBuffers[i];
-		
-		// Set this mesh's buffers
-		d3dDevice->SetStreamSource(0, meshData.vertexBuffer, 0, sizeof(DXVertex));
-		d3dDevice->SetIndices(meshData.indexBuffer);
+		// Set this mesh's buffers, unless the previous draw already did
+		if (&meshData != bound) {
+			d3dDevice->SetStreamSource(0, meshData.vertexBuffer, 0, sizeof(DXVertex));
+			d3dDevice->SetIndices(meshData.indexBuffer);
+			bound = &meshData;
+			frameStats.stateChanges++;
+		} else {
+			frameStats.redundantStateChanges++;
+		}
+
+		IDirect3DTexture9* texture = (mesh->texture && mesh->texture->Ready())
+			? reinterpret_cast<IDirect3DTexture9*>(mesh->texture->Handle()) : nullptr;
+		if (texture != boundTexture) {
+			if (texture && !boundTexture) {
+				d3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);
+				d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+				d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+			} else if (!texture) {
+				d3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, oldColorOp);
+				d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, oldColorArg1);
+				d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG2, oldColorArg2);
+			}
+			d3dDevice->SetTexture(0, texture);
+			boundTexture = texture;
+		}
 		
 		// Create world transformation matrix for this mesh
-		glm::mat4 worldGL = glm::mat4(1.0f);
-		worldGL = glm::translate(worldGL, mesh->transform.position);
-		worldGL = glm::rotate(worldGL, glm::radians(mesh->transform.rotation.y), glm::vec3(0,1,0));
-		worldGL = glm::rotate(worldGL, glm::radians(mesh->transform.rotation.x), glm::vec3(1,0,0));
-		worldGL = glm::rotate(worldGL, glm::radians(mesh->transform.rotation.z), glm::vec3(0,0,1));
+		glm::mat4 worldGL = FrustumCuller::DrawMatrix(mesh->transform);
 		
 		auto worldMtr = ToD3D(worldGL);
 		d3dDevice->SetTransform(D3DTS_WORLD, &worldMtr);
 		
-		// Draw this mesh
+		// Draw this mesh at the level its screen size calls for
+		size_t lod = mesh->SelectLod(cam->transform.position, lodPixelScale, lodMaxError);
+		if (lod >= (size_t)meshData.lodLevels) lod = 0;
+		lodStats.Record(lod, *meshData.source);
+		
 		d3dDevice->DrawIndexedPrimitive(
 			D3DPT_TRIANGLELIST,
-			0,                      // BaseVertexIndex
-			0,                      // MinIndex  
-			meshData.vertexCount,   // NumVertices
-			0,                      // StartIndex
-			meshData.triangleCount  // PrimitiveCount
+			0,                              // BaseVertexIndex
+			0,                              // MinIndex  
+			meshData.vertexCount,           // NumVertices
+			meshData.lodStart[lod],         // StartIndex
+			meshData.lodIndexCount[lod] / 3 // PrimitiveCount
 		);
+		frameStats.drawCalls++;
+		frameStats.triangles += meshData.lodIndexCount[lod] / 3;
 	}
+	if (boundTexture) {
+		d3dDevice->SetTexture(0, nullptr);
+		d3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, oldColorOp);
+		d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, oldColorArg1);
+		d3dDevice->SetTextureStageState(0, D3DTSS_COLORARG2, oldColorArg2);
+	}
+
+	frameStats.debugVertices  = static_cast<uint32_t>(debugDraw.VertexCount());
+	frameStats.debugDrawCalls = DrawDebug(debugDraw);
 
 	d3dDevice->EndScene();
+	frameStats.cpuMs = static_cast<float>((glfwGetTime() - frameStart) * 1000.0);
 	d3dDevice->Present(nullptr, nullptr, nullptr, nullptr);
 }
@@ -3,7 +3,11 @@
 
 #include "IRenderer.h"
 #include "Mesh.h"
+#include "FrustumCuller.h"
+#include "StaticBatcher.h"
+#include "RenderQueue.h"
 #include <memory>
+#include <unordered_map>
 #include <windows.h>
 #include <d3d9.h>
 #include <glm/glm.hpp>
@@ -14,14 +18,33 @@ struct DX9MeshData {
 	IDirect3DVertexBuffer9* vertexBuffer = nullptr;
 	IDirect3DIndexBuffer9* indexBuffer = nullptr;
 	int vertexCount = 0;
+	int indexCount = 0;
 	int triangleCount = 0;
+	bool index32 = false;
+	// every LOD level lives in the same index buffer, back to back
+	int lodLevels = 0;
+	int lodStart[MaxMeshLods] = {};
+	int lodIndexCount[MaxMeshLods] = {};
+	// geometry the buffers were filled from; instances of it share this object
+	std::shared_ptr<const MeshGeometry> source;
+	uint32_t id = 0;   // unique per buffer set, used in draw sort keys
 	
+	DX9MeshData() = default;
+	DX9MeshData(const DX9MeshData&) = delete;
+	DX9MeshData& operator=(const DX9MeshData&) = delete;
 	~DX9MeshData() {
 		if (vertexBuffer) vertexBuffer->Release();
 		if (indexBuffer) indexBuffer->Release();
 	}
 };
 
+// DebugVertex with its colour in D3DCOLOR (ARGB) order
+struct DXDebugVertex {
+	float    x,y,z;
+	D3DCOLOR color;
+};
+#define D3DFVF_DXDEBUGVERTEX (D3DFVF_XYZ | D3DFVF_DIFFUSE)
+
 class RendererDX9 : public IRenderer {
 public:
 	bool Init(Camera *cam, Runtime::Runtime *runtime) override;
@@ -30,9 +53,16 @@ public:
 	bool UpdateMesh(int indx, std::shared_ptr<Mesh> msh) override;
 	bool DeleteMesh(int indx) override;
 	int AddMesh(std::shared_ptr<Mesh> mesh) override;
+	bool UpdateTransform(int indx, const Transform& transform) override;
+	bool UpdateGeometryRange(int indx, size_t first, size_t count) override;
 	bool KeyIsDown(int key);
-	ImageData CaptureFrame() override;
+	const ImageData& CaptureFrame() override;
 	void setSize(int newWidth, int newHeight) override;
+	// managed pool, so textures outlive device resets; BC1/BC3 go up as
+	// DXT1/DXT5, BC5 isn't taken
+	uintptr_t CreateTexture(int width, int height, int mipCount, PixelFormat format) override;
+	bool UploadTextureLevel(uintptr_t texture, int level, int width, int height, const uint8_t* data, size_t size) override;
+	void DeleteTexture(uintptr_t texture) override;
 	void RenderSkybox();
 	
 private:
@@ -44,7 +74,17 @@ private:
 	UINT                               height     = 600;
 
 	std::vector<std::shared_ptr<Mesh>> meshes;
-	std::vector<DX9MeshData> meshBuffers;
+	std::vector<std::shared_ptr<DX9MeshData>> meshBuffers;
+	std::unordered_map<const MeshGeometry*, std::weak_ptr<DX9MeshData>> geometryBuffers;
+	FrustumCuller culler;
+	std::vector<uint32_t> visibleMeshes;
+	// merged static meshes, one buffer set per StaticBatcher batch
+	StaticBatcher batcher;
+	std::vector<std::shared_ptr<DX9MeshData>> batchBuffers;
+	FrustumCuller batchCuller;
+	std::vector<uint32_t> visibleBatches;
+	RenderQueue renderQueue;
+	std::vector<DXDebugVertex> debugVertices;   // debugDraw with D3D colours, reused
 	UINT                               numberOfMeshVertexes = 0;
 	LPDIRECT3DVERTEXBUFFER9            vb         = nullptr;
 	LPDIRECT3DINDEXBUFFER9             ib         = nullptr;
@@ -70,6 +110,8 @@ private:
 		};
 	}
 
+	std::shared_ptr<DX9MeshData> BuffersFor(const std::shared_ptr<const MeshGeometry>& geometry);
+	uint32_t DrawDebug(const DebugDrawList& list);
 	void ResetDevice();
 	void HandleInputDX9(float dt);
 	static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -4,23 +4,25 @@
 #include "../Core/Logger.h"
 #include <GLFW/glfw3.h>
 #include <GL/gl.h>
-#ifndef PI
-  #define PI 3.14159265358979323846f
-#endif
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <string>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Mesh.h"
-#include "../Core/stb_impl.h"
+#include "TextureManager.h"
 
 #include "../Core/EditorPanels.h"
 
 // globals for our window and state
 static GLFWwindow* window      = nullptr;
-static int        winWidth     = 800;
-static int        winHeight    = 600;
+static std::atomic<int> winWidth{800};   // written by the event thread
+static std::atomic<int> winHeight{600};
 static float      angle        = 0.0f;
 static double     lastTime     = 0.0;
 
@@ -28,132 +30,40 @@ static double     lastTime     = 0.0;
 static bool  glfwMouseCaptured = true;
 static bool  leftWasDown       = false;
 
+// GLFW is up; on its null platform when offscreen contexts need no display
+static bool  glfwStarted      = false;
+static bool  glfwNullPlatform = false;
+
 // skybox globals
 static GLuint skyboxTexture = 0;
 
+static const float NearPlane = 0.1f;
+static const float FarPlane  = 100.0f;
+
+// render queue items with this bit set index a static batch, not a mesh slot
+static const uint32_t BatchDraw = 0x80000000u;
+
+// material field of a draw's sort key: its texture, if it draws with one
+static uint32_t MaterialKey(const Mesh& mesh, const Renderer::GLMeshBuffers& buffers) {
+	if (!mesh.texture || !mesh.texture->Ready() || buffers.packed) {
+		return 0;
+	}
+	return mesh.texture->Id();
+}
+
 static void FramebufferSizeCallback(GLFWwindow* wnd, int width, int height) {
 	winWidth  = width;
 	winHeight = height;
-	glViewport(0, 0, width, height);
 }
 
-// -----------------------------------------------------------------------------
-// at top of RendererGL21.cpp, after your #includes:
-// -----------------------------------------------------------------------------
-
-// tesselation detail
-static const int ARROW_SEGMENTS = 16;
-
-// draw a unit cylinder along +Z from z=0..1, radius=1
-static void DrawUnitCylinder()
-{
-    for(int i = 0; i < ARROW_SEGMENTS; ++i) {
-        float a0 = 2.0f * PI * (float)i       / ARROW_SEGMENTS;
-        float a1 = 2.0f * PI * (float)(i + 1) / ARROW_SEGMENTS;
-        float x0 = cosf(a0), y0 = sinf(a0);
-        float x1 = cosf(a1), y1 = sinf(a1);
-        // side quad (two triangles):
-        glBegin(GL_TRIANGLES);
-          // first tri
-          glNormal3f(x0, y0, 0);
-          glVertex3f(x0, y0, 0);
-          glVertex3f(x0, y0, 1);
-          glVertex3f(x1, y1, 1);
-          // second tri
-          glNormal3f(x0, y0, 0);
-          glVertex3f(x0, y0, 0);
-          glVertex3f(x1, y1, 1);
-          glVertex3f(x1, y1, 0);
-        glEnd();
-    }
-}
-
-// draw a unit cone along +Z from z=0..1, base radius=1 at z=0, tip at z=1
-static void DrawUnitCone()
-{
-    glm::vec3 tip(0,0,1.0f);
-    for(int i = 0; i < ARROW_SEGMENTS; ++i) {
-        float a0 = 2.0f * PI * (float)i       / ARROW_SEGMENTS;
-        float a1 = 2.0f * PI * (float)(i + 1) / ARROW_SEGMENTS;
-        float x0 = cosf(a0), y0 = sinf(a0);
-        float x1 = cosf(a1), y1 = sinf(a1);
-        // single triangle per segment
-        // compute normals by cross-product:
-        glm::vec3 p0(x0, y0, 0.0f), p1(x1, y1, 0.0f);
-        glm::vec3 edge0 = p0 - tip;
-        glm::vec3 edge1 = p1 - tip;
-        glm::vec3 n = glm::normalize(glm::cross(edge1, edge0));
-        glBegin(GL_TRIANGLES);
-          glNormal3f(n.x, n.y, n.z);
-          glVertex3f(p0.x, p0.y, p0.z);
-          glVertex3f(p1.x, p1.y, p1.z);
-          glVertex3f(tip.x, tip.y, tip.z);
-        glEnd();
-    }
-}
-
-// draw an arrow at origin, pointing along +Z.
-//  shaftLength = total length - headLength
-//  shaftRadius, headRadius, headLength in same units.
-static void DrawUnitArrow(float shaftRadius, float headRadius, float headLength, float totalLength)
-{
-    float shaftLength = totalLength - headLength;
-
-    // --- draw shaft ---
-    glPushMatrix();
-      // scale X/Y by radius, Z by length
-      glScalef(shaftRadius, shaftRadius, shaftLength);
-      DrawUnitCylinder();
-    glPopMatrix();
-
-    // --- draw head ---
-    glPushMatrix();
-      // translate to end of shaft
-      glTranslatef(0, 0, shaftLength);
-      // scale X/Y by headRadius, Z by headLength
-      glScalef(headRadius, headRadius, headLength);
-      DrawUnitCone();
-    glPopMatrix();
-}
-
-// orient & draw arrow from 'start' in 'dir' direction
-static void DrawArrow(const glm::vec3& start, 
-                      const glm::vec3& dir, 
-                      float shaftRadius, 
-                      float headRadius, 
-                      float headLength)
+// editor gizmo: X/Y/Z arrows at a mesh origin, drawn on top of everything
+static void AddArrowGizmos(Renderer::DebugDrawList& list, const glm::vec3& origin, float scale=1.0f)
 {
-    float totalLength = glm::length(dir);
-    if (totalLength < 1e-6f) return;
-
-    // compute rotation: align local +Z to dir
-    glm::vec3 axis = glm::cross(glm::vec3(0,0,1), dir);
-    float angle = acosf(glm::dot(glm::normalize(dir), glm::vec3(0,0,1)));
-    
-    glPushMatrix();
-      glTranslatef(start.x, start.y, start.z);
-      if (glm::length(axis) > 1e-6f)
-        glRotatef(glm::degrees(angle), axis.x, axis.y, axis.z);
-      // draw the unit arrow along +Z
-      DrawUnitArrow(shaftRadius, headRadius, headLength, totalLength);
-    glPopMatrix();
-}
-
-// helper: draw X/Y/Z arrows at mesh origin
-static void DrawArrowGizmos(const glm::vec3& origin, float scale=1.0f)
-{
-    float shaftR = 0.02f * scale;
-    float headR  = 0.06f * scale;
-    float headL  = 0.2f  * scale;
-    // X = red
-    glColor3f(1,0,0);
-    DrawArrow(origin, glm::vec3(scale,0,0), shaftR, headR, headL);
-    // Y = green
-    glColor3f(0,1,0);
-    DrawArrow(origin, glm::vec3(0,scale,0), shaftR, headR, headL);
-    // Z = blue
-    glColor3f(0,0,1);
-    DrawArrow(origin, glm::vec3(0,0,scale), shaftR, headR, headL);
+	float shaftR = 0.02f * scale;
+	float headL  = 0.2f  * scale;
+	list.Arrow(origin, origin + glm::vec3(scale,0,0), Renderer::DebugDrawList::Color(1,0,0), shaftR, headL, false);
+	list.Arrow(origin, origin + glm::vec3(0,scale,0), Renderer::DebugDrawList::Color(0,1,0), shaftR, headL, false);
+	list.Arrow(origin, origin + glm::vec3(0,0,scale), Renderer::DebugDrawList::Color(0,0,1), shaftR, headL, false);
 }
 
 
@@ -215,36 +125,54 @@ static float skyboxVertices[] = {
 	-1.0,   1.0,    -1.0,   0.251,   0.3333333333333333,
 };
 
-// Load skybox texture from bitmap file
+// Load skybox texture; a cooked .gwtex next to the bitmap is used instead
+// when it's newer, its blocks uploaded as they are if the driver takes them
 void Renderer::RendererGL21::CreateSkyboxTexture(const char* filename) {
-	int width, height, channels;
-	unsigned char* data = stb_impl::LoadImageFromFile(filename, &width, &height, &channels);
-	
-	if (!data) {
+	TextureImage image;
+	if (!image.Load(filename)) {
 		printf("Failed to load skybox texture, creating default texture\n");
 		// Create a simple default texture if loading fails
 		const int size = 256;
-		data = new unsigned char[size * size * channels];
-		width = height = size;
+		image.format = PixelFormat::RGBA8;
+		image.mips.assign(1, TextureMip());
+		image.mips[0].width  = size;
+		image.mips[0].height = size;
+		image.mips[0].data.resize(size * size * 4);
 		
 		for (int y = 0; y < size; y++) {
 			for (int x = 0; x < size; x++) {
-				int idx = (y * size + x) * channels;
+				uint8_t* texel = image.mips[0].data.data() + (y * size + x) * 4;
 				float t = (float)y / (float)size;
-				data[idx + 0] = (unsigned char)(134 + (206 - 134) * t);
-				data[idx + 1] = (unsigned char)(206 + (234 - 206) * t);
-				data[idx + 2] = (unsigned char)(234 + (255 - 234) * t);
+				texel[0] = (unsigned char)(134 + (206 - 134) * t);
+				texel[1] = (unsigned char)(206 + (234 - 206) * t);
+				texel[2] = (unsigned char)(234 + (255 - 234) * t);
+				texel[3] = 255;
 			}
 		}
 	}
+	// the atlas is sampled at level 0 only; mips would bleed across faces
+	image.mips.resize(1);
 
-	glGenTextures(1, &skyboxTexture);
+	uintptr_t texture = CreateTexture(image.Width(), image.Height(), 1, image.format);
+	if (!texture && image.IsCompressed()) {
+		image.Decompress();
+		texture = CreateTexture(image.Width(), image.Height(), 1, image.format);
+	}
+	skyboxTexture = GLuint(texture);
+	UploadTextureLevel(texture, 0, image.Width(), image.Height(), image.mips[0].data.data(), image.mips[0].data.size());
 	glBindTexture(GL_TEXTURE_2D, skyboxTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// lighting reads texels, so a compressed atlas is expanded on the CPU for it
+	if (image.IsCompressed()) {
+		image.Decompress();
+	}
+	const uint8_t* data = image.mips[0].data.data();
+	int width  = image.Width();
+	int height = image.Height();
+	const int channels = 4;
 	
 	
 	// sample colors from the skybox for lighting
@@ -288,8 +216,6 @@ void Renderer::RendererGL21::CreateSkyboxTexture(const char* filename) {
 	skybox_r = (totalr/totalstrength)/255.0f;
 	skybox_g = (totalg/totalstrength)/255.0f;
 	skybox_b = (totalb/totalstrength)/255.0f;
-	
-	delete[] data;
 }
 
 static void RenderSkybox() {
@@ -333,15 +259,64 @@ static void RenderSkybox() {
 
 bool Renderer::RendererGL21::SetMeshes(std::vector<std::shared_ptr<Mesh>> msh) {
 	meshes = std::move(msh);
+	
+	// hold on to the old buffers until the new list has picked up the ones it shares
+	std::vector<std::shared_ptr<GLMeshBuffers>> previous = std::move(meshBuffers);
+	meshBuffers.clear();
+	meshBuffers.resize(meshes.size());
+	batcher.Clear();
+	batchBuffers.clear();
+	
+	for (int meshi = 0; meshi < meshes.size(); meshi++) {
+		UpdateMesh(meshi, meshes[meshi]);
+	}
 	return true;
 }
 
 bool Renderer::RendererGL21::UpdateMesh(int indx, std::shared_ptr<Mesh> msh){
 	if (indx >= meshes.size()) {
 		meshes.resize(indx+1);
+		meshBuffers.resize(indx+1);
 	}
 	meshes[indx] = msh;
-	return true;
+	
+	if (!msh || !msh->geometry) {
+		batcher.Remove(indx);
+		meshBuffers[indx] = nullptr;
+		return msh != nullptr;
+	}
+	
+	// static meshes are drawn from their batch, not from their own buffers
+	if (batcher.Update(indx, msh)) {
+		meshBuffers[indx] = nullptr;
+		return true;
+	}
+	
+	// Transform-only updates keep the slot's buffers untouched
+	if (meshBuffers[indx] && meshBuffers[indx]->source == msh->geometry) {
+		return true;
+	}
+	
+	meshBuffers[indx] = BuffersFor(msh->geometry);
+	return meshBuffers[indx] != nullptr;
+}
+
+// Returns the buffers for `geometry`, uploading it only if no other mesh
+// slot already holds them.
+std::shared_ptr<Renderer::GLMeshBuffers> Renderer::RendererGL21::BuffersFor(const std::shared_ptr<const MeshGeometry>& geometry) {
+	auto found = geometryBuffers.find(geometry.get());
+	if (found != geometryBuffers.end()) {
+		if (auto shared = found->second.lock()) {
+			return shared;
+		}
+		geometryBuffers.erase(found);
+	}
+	
+	auto buffers = GLMeshBuffers::Create(geometry, GLExt::HasVertexBuffers());
+	if (buffers) {
+		geometryBuffers[geometry.get()] = buffers;
+	}
+	return buffers;
 }
 
 int Renderer::RendererGL21::AddMesh(std::shared_ptr<Mesh> mesh) {
@@ -357,12 +332,49 @@ int Renderer::RendererGL21::AddMesh(std::shared_ptr<Mesh> mesh) {
 	return indx;
 }
 
+bool Renderer::RendererGL21::UpdateTransform(int indx, const Transform& transform) {
+	if (indx < 0 || indx >= meshes.size() || !meshes[indx]) {
+		return false;
+	}
+	
+	// the modelview is rebuilt from the transform every frame; nothing to upload
+	// unless the mesh is static, in which case only its batches re-merge
+	meshes[indx]->transform = transform;
+	batcher.Update(indx, meshes[indx]);
+	return true;
+}
+
+bool Renderer::RendererGL21::UpdateGeometryRange(int indx, size_t first, size_t count) {
+	if (indx < 0 || indx >= meshes.size() || !meshes[indx] || !meshes[indx]->geometry) {
+		return false;
+	}
+	
+	if (batcher.IsBatched(indx)) {
+		batcher.Invalidate(indx);
+		return true;
+	}
+	
+	// buffers that are missing or stale get a full upload instead
+	if (indx >= meshBuffers.size() || !meshBuffers[indx] || meshBuffers[indx]->source != meshes[indx]->geometry) {
+		return UpdateMesh(indx, meshes[indx]);
+	}
+	if (!meshBuffers[indx]->UpdateVertices(first, count)) {
+		return false;
+	}
+	// moved vertices may leave the bounds the culler has
+	culler.Extend(*meshes[indx]->geometry, first, count);
+	return true;
+}
+
 bool Renderer::RendererGL21::DeleteMesh(int indx) {
 	if (indx < 0 || indx >= meshes.size()) {
 		return false;
 	}
 	
+	// The buffers go away with the last slot that shares them
+	batcher.Remove(indx);
 	meshes[indx] = nullptr;
+	meshBuffers[indx] = nullptr;
 	return true;
 }
 
@@ -370,19 +382,67 @@ bool Renderer::RendererGL21::Init(Camera* c, Runtime::Runtime *r) {
 	runtime = r;
 	cam     = c;
 
-	// ——— 1) Detect Editor vs Play ———
-	// We'll hide the window entirely if this is the EditorRuntime
-	bool isEditor = (dynamic_cast<Runtime::EditorRuntime*>(runtime) != nullptr);
+	if (output == GLOutput::Hosted) {
+		// GL waits for AttachHost; GLFW is only needed for its timer
+		if (!InitGLFW()) {
+			return false;
+		}
+		glfwMouseCaptured = false;
+		lastTime = glfwGetTime();
+		Logger::Info("OpenGL 2.1 renderer waiting for a host context.");
+		return true;
+	}
 
-	// ——— 2) Init GLFW ———
+	if (!CreateContext() || !InitGLState()) {
+		return false;
+	}
+
+	// hide & capture mouse by default
+	glfwMouseCaptured = output == GLOutput::Window;
+	if (glfwMouseCaptured) {
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
+	leftWasDown       = false;
+
+	lastTime = glfwGetTime();
+	if (output == GLOutput::Headless) {
+		Logger::Info("Headless GL context, " + std::to_string(int(winWidth)) + "x" + std::to_string(int(winHeight)) + " offscreen target, lighting and skybox initialized.");
+	} else {
+		Logger::Info("GLFW window, context, lighting, skybox, and MSAA initialized.");
+	}
+	return true;
+}
+
+// Offscreen runs want no display connection at all. GLFW 3.4's null
+// platform gets its contexts from OSMesa or EGL; older GLFW, or a machine
+// without either, falls back to a hidden window in CreateContext.
+bool Renderer::RendererGL21::InitGLFW() {
+	glfwNullPlatform = false;
+#ifdef GLFW_PLATFORM_NULL
+	if (output != GLOutput::Window && glfwPlatformSupported(GLFW_PLATFORM_NULL)) {
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+		glfwNullPlatform = true;
+	}
+#endif
 	if (!glfwInit()) {
 		Logger::Error("Failed to initialize GLFW.");
 		return false;
 	}
+	glfwStarted = true;
+	return true;
+}
+
+bool Renderer::RendererGL21::CreateContext() {
+	bool offscreenOnly = output != GLOutput::Window;
+
+	// ——— 1) Init GLFW ———
+	if (!glfwStarted && !InitGLFW()) {
+		return false;
+	}
 
-	// ——— 3) Window hints ———
-	// Hide the window if in editor mode, otherwise show it
-	glfwWindowHint(GLFW_VISIBLE, isEditor ? GLFW_FALSE : GLFW_TRUE);
+	// ——— 2) Window hints ———
+	// Only a windowed renderer shows its window
+	glfwWindowHint(GLFW_VISIBLE, offscreenOnly ? GLFW_FALSE : GLFW_TRUE);
 
 	// OpenGL 2.1 context
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
@@ -391,29 +451,54 @@ bool Renderer::RendererGL21::Init(Camera* c, Runtime::Runtime *r) {
 
 	// Window features
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
-	glfwWindowHint(GLFW_SAMPLES,   4);
+	// offscreen frames go to a target that isn't multisampled
+	glfwWindowHint(GLFW_SAMPLES,   offscreenOnly ? 0 : 4);
 
-	// ——— 4) Create window & context ———
+	// ——— 3) Create window & context ———
+	// offscreen only needs the window for its context
 	window = glfwCreateWindow(
-		winWidth, winHeight,
+		offscreenOnly ? 1 : int(winWidth), offscreenOnly ? 1 : int(winHeight),
 		"HL2-Style Engine - OpenGL 2.1",
 		nullptr, nullptr
 	);
+#ifdef GLFW_PLATFORM_NULL
+	if (!window && glfwNullPlatform) {
+		Logger::Warn("No display-less GL context available; using a hidden window.");
+		glfwTerminate();
+		glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
+		glfwNullPlatform = false;
+		if (glfwInit()) {
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+			glfwWindowHint(GLFW_SAMPLES, 0);
+			window = glfwCreateWindow(1, 1, "HL2-Style Engine - OpenGL 2.1", nullptr, nullptr);
+		}
+	}
+#endif
 	if (!window) {
 		Logger::Error("Failed to create GLFW window.");
 		glfwTerminate();
+		glfwStarted = false;
 		return false;
 	}
 	glfwMakeContextCurrent(window);
-	glfwSwapInterval(1);
+	glfwSwapInterval(offscreenOnly ? 0 : 1);
+	GLExt::Load();
 
-	// ——— 5) Setup callbacks & GL state ———
-	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
-	glViewport(0, 0, winWidth, winHeight);
+	if (!offscreenOnly) {
+		glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+	}
+	return true;
+}
 
+// State the frame relies on. Set once for a context of our own; a host
+// gets it back every frame, inside SaveHostState/RestoreHostState.
+void Renderer::RendererGL21::SetFrameState() {
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
-	glFrontFace(GL_CW);
+	// hosted frames are drawn upside down, which flips the winding
+	glFrontFace(output == GLOutput::Hosted ? GL_CCW : GL_CW);
 	glCullFace(GL_FRONT);
 
 	glClearColor(20/255.0f, 20/255.0f, 50/255.0f, 1.0f);
@@ -423,6 +508,19 @@ bool Renderer::RendererGL21::Init(Camera* c, Runtime::Runtime *r) {
 	glEnable(GL_LIGHT0);
 	glEnable(GL_NORMALIZE);
 	glShadeModel(GL_SMOOTH);
+}
+
+bool Renderer::RendererGL21::InitGLState() {
+	// ——— Offscreen target & GL state ———
+	if (output == GLOutput::Headless) {
+		if (!offscreen.Resize(winWidth, winHeight)) {
+			Logger::Error("Offscreen rendering needs framebuffer objects.");
+			return false;
+		}
+		offscreen.Bind();
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	SetFrameState();
 
 	// Create skybox texture
 	CreateSkyboxTexture("assets/textures/skybox.bmp");
@@ -444,49 +542,349 @@ bool Renderer::RendererGL21::Init(Camera* c, Runtime::Runtime *r) {
 	glMaterialfv(GL_FRONT, GL_AMBIENT, matAmb);
 	glMaterialfv(GL_FRONT, GL_DIFFUSE, matDif);
 
-	// hide & capture mouse by default
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-	glfwMouseCaptured = true;
-	leftWasDown       = false;
+	glReady = true;
+	return true;
+}
 
-	lastTime = glfwGetTime();
-	Logger::Info("GLFW window, context, lighting, skybox, and MSAA initialized.");
+bool Renderer::RendererGL21::AttachHost(GLExt::ProcLoader getProcAddress) {
+	if (output != GLOutput::Hosted || glReady) {
+		return false;
+	}
+	GLExt::Load(getProcAddress);
+	if (!GLExt::HasFramebuffers()) {
+		Logger::Warn("Host context has no framebuffer objects; can't render into it.");
+		return false;
+	}
+	hostRectangles = GLExt::ExtensionSupported("GL_ARB_texture_rectangle");
+	SaveHostState();
+	bool ok = InitGLState();
+	RestoreHostState();
+	if (ok) {
+		Logger::Info("OpenGL 2.1 renderer drawing in the host's context.");
+	}
+	return ok;
+}
+
+bool Renderer::RendererGL21::CreateOwnContext() {
+	if (output != GLOutput::Hosted || glReady) {
+		return false;
+	}
+	output = GLOutput::Headless;
+	if (!CreateContext() || !InitGLState()) {
+		return false;
+	}
+	Logger::Info("OpenGL 2.1 renderer drawing offscreen in a context of its own.");
+	return true;
+}
+
+bool Renderer::RendererGL21::SetHostTarget(GLuint texture, GLenum target, int width, int height) {
+	if (output != GLOutput::Hosted || !glReady) {
+		return false;
+	}
+	SaveHostState();
+	bool ok = texture ? offscreen.Attach(texture, target, width, height) : offscreen.Resize(width, height);
+	RestoreHostState();
+	if (ok) {
+		winWidth  = width;
+		winHeight = height;
+	}
+	return ok;
+}
+
+bool Renderer::RendererGL21::SetHostTargetFromBinding(bool rectangle, int width, int height) {
+	if (output != GLOutput::Hosted || !glReady || (rectangle && !hostRectangles)) {
+		return false;
+	}
+	GLint name = 0;
+	glGetIntegerv(rectangle ? GL_TEXTURE_BINDING_RECTANGLE_ARB : GL_TEXTURE_BINDING_2D, &name);
+	return name && SetHostTarget(GLuint(name), rectangle ? GL_TEXTURE_RECTANGLE_ARB : GL_TEXTURE_2D, width, height);
+}
+
+void Renderer::RendererGL21::DetachHost() {
+	if (output != GLOutput::Hosted || !glReady) {
+		return;
+	}
+	SaveHostState();
+	ReleaseGL();
+	RestoreHostState();
+}
+
+// The host (SDL's GL renderer) caches the GL state it last set, so every
+// bit of ours is undone before it draws again.
+void Renderer::RendererGL21::SaveHostState() {
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &hostFramebuffer);
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_ALL_ATTRIB_BITS);
+	for (GLenum mode : {GL_TEXTURE, GL_PROJECTION, GL_MODELVIEW}) {
+		glMatrixMode(mode);
+		glPushMatrix();
+	}
+	// whatever the host left enabled, our draws don't expect
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_BLEND);
+	glDisable(GL_TEXTURE_2D);
+	if (hostRectangles) {
+		glDisable(GL_TEXTURE_RECTANGLE_ARB);
+	}
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void Renderer::RendererGL21::RestoreHostState() {
+	if (GLExt::HasVertexBuffers()) {
+		GLMeshBuffers::Unbind();
+	}
+	for (GLenum mode : {GL_TEXTURE, GL_PROJECTION, GL_MODELVIEW}) {
+		glMatrixMode(mode);
+		glPopMatrix();
+	}
+	glPopClientAttrib();
+	glPopAttrib();
+	if (GLExt::HasFramebuffers()) {
+		GLExt::BindFramebuffer(GL_FRAMEBUFFER, GLuint(hostFramebuffer));
+	}
+}
+
+// Frames are queued for readback at the end of RenderFrame, so this
+// returns one from a frame or two ago; the first calls come back empty.
+const Renderer::ImageData& Renderer::RendererGL21::CaptureFrame() {
+	captureRequested = true;
+	readback.Collect(capture);
+	return capture;
+}
+
+// GL objects go first, while their context still exists
+void Renderer::RendererGL21::ReleaseGL() {
+	TextureManager::ReleaseAll(*this);
+	readback.Release();
+	debugRenderer.Release();
+	ReleaseSceneTarget();
+	offscreen.Release();
+	meshes.clear();
+	meshBuffers.clear();
+	geometryBuffers.clear();
+	batcher.Clear();
+	batchBuffers.clear();
+	if (skyboxTexture) {
+		DeleteTexture(skyboxTexture);
+		skyboxTexture = 0;
+	}
+	glReady = false;
+}
+
+uintptr_t Renderer::RendererGL21::CreateTexture(int width, int height, int mipCount, PixelFormat format) {
+	GLenum compressed = 0;
+	switch (format) {
+	case PixelFormat::BC1: compressed = GLExt::HasS3TC() ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;  break;
+	case PixelFormat::BC3: compressed = GLExt::HasS3TC() ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0; break;
+	case PixelFormat::BC5: compressed = GLExt::HasRGTC() ? GL_COMPRESSED_RG_RGTC2 : 0;           break;
+	default: break;
+	}
+	if (format != PixelFormat::RGBA8 && !compressed) {
+		return 0;
+	}
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	if (!texture) {
+		return 0;
+	}
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// complete once every level we have is there, the chain may stop above 1x1
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (std::max)(0, mipCount - 1));
+	glBindTexture(GL_TEXTURE_2D, 0);
+	if (compressed) {
+		compressedTextures[texture] = compressed;
+	}
+	return texture;
+}
+
+bool Renderer::RendererGL21::UploadTextureLevel(uintptr_t texture, int level, int width, int height, const uint8_t* data, size_t size) {
+	GLuint name = GLuint(texture);
+	// glGetError reports the oldest error first; drop any left by earlier
+	// draws so only this upload's count
+	while (glGetError() != GL_NO_ERROR) {}
+	glBindTexture(GL_TEXTURE_2D, name);
+	auto compressed = compressedTextures.find(name);
+	if (compressed != compressedTextures.end()) {
+		// the blocks go up as they are, no decode on either side
+		GLExt::CompressedTexImage2D(GL_TEXTURE_2D, level, compressed->second, width, height, 0, GLsizei(size), data);
+	} else {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return glGetError() == GL_NO_ERROR;
+}
+
+void Renderer::RendererGL21::DeleteTexture(uintptr_t texture) {
+	GLuint name = GLuint(texture);
+	compressedTextures.erase(name);
+	glDeleteTextures(1, &name);
+}
+
+// Sets up the scene pass at the controller's scale: feeds it the newest
+// GPU time, (re)sizes the target and binds it. Returns false, leaving the
+// output bound, when dynamic resolution is off or can't work here.
+bool Renderer::RendererGL21::BeginScaledScene(int outputWidth, int outputHeight, int& sceneWidth, int& sceneHeight) {
+	if (!dynamicResolution.enabled) {
+		if (sceneTarget.Valid() || sceneTexture) {
+			ReleaseSceneTarget();
+		}
+		sceneTargetFailed = false;
+		return false;
+	}
+	if (sceneTargetFailed) {
+		return false;
+	}
+
+	float measured = 0.0f;
+	if (sceneTimer.Collect(measured)) {
+		sceneGpuMs = measured;
+		resolutionController.Update(dynamicResolution, measured);
+	}
+	float scale = resolutionController.Scale();
+
+	// sized for the largest scale allowed, so the controller moving around
+	// inside its bounds never reallocates
+	float largest = (std::min)((std::max)(dynamicResolution.maxScale, scale), 2.0f);
+	int targetWidth  = (std::max)(1, int(std::ceil(outputWidth  * largest)));
+	int targetHeight = (std::max)(1, int(std::ceil(outputHeight * largest)));
+	if (sceneTarget.Width() != targetWidth || sceneTarget.Height() != targetHeight) {
+		if (!sceneTexture) {
+			glGenTextures(1, &sceneTexture);
+		}
+		glBindTexture(GL_TEXTURE_2D, sceneTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetWidth, targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		if (!sceneTarget.Attach(sceneTexture, GL_TEXTURE_2D, targetWidth, targetHeight)) {
+			Logger::Error("Dynamic resolution needs an offscreen scene target; drawing at full scale.");
+			ReleaseSceneTarget();
+			sceneTargetFailed = true;
+			BindOutput();
+			return false;
+		}
+	}
+
+	sceneWidth  = (std::min)(targetWidth,  (std::max)(1, int(std::lround(outputWidth  * scale))));
+	sceneHeight = (std::min)(targetHeight, (std::max)(1, int(std::lround(outputHeight * scale))));
+	sceneTarget.Bind();
+	glViewport(0, 0, sceneWidth, sceneHeight);
+	// glClear ignores the viewport; keep it to the part we draw
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(0, 0, sceneWidth, sceneHeight);
+
+	frameStats.resolutionScale = scale;
+	frameStats.sceneGpuMs      = sceneGpuMs;
+	sceneTimer.Begin();
 	return true;
 }
 
-Renderer::ImageData Renderer::RendererGL21::CaptureFrame() {
-	ImageData data;
-	data.width  = winWidth;
-	data.height = winHeight;
-	data.pixels.resize(winWidth * winHeight * 4);
+// Stretches the scene over the output with a bilinear textured quad. A
+// blit would do the same, but can't target a multisampled window.
+void Renderer::RendererGL21::EndScaledScene(int outputWidth, int outputHeight, int sceneWidth, int sceneHeight) {
+	sceneTimer.End();
+	glDisable(GL_SCISSOR_TEST);
+	BindOutput();
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, sceneTexture);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	glColor3f(1.0f, 1.0f, 1.0f);
 
-	glReadPixels(0, 0, winWidth, winHeight, GL_RGBA, GL_UNSIGNED_BYTE, data.pixels.data());
+	// a hosted scene is already upside down and stays that way
+	float u = float(sceneWidth)  / float(sceneTarget.Width());
+	float v = float(sceneHeight) / float(sceneTarget.Height());
+	glBegin(GL_QUADS);
+	glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+	glTexCoord2f(u,    0.0f); glVertex2f( 1.0f, -1.0f);
+	glTexCoord2f(u,    v);    glVertex2f( 1.0f,  1.0f);
+	glTexCoord2f(0.0f, v);    glVertex2f(-1.0f,  1.0f);
+	glEnd();
 
-	// flip vertically
-	std::vector<unsigned char> flipped(winWidth * winHeight * 4);
-	for (int y = 0; y < winHeight; ++y) {
-		memcpy(
-			&flipped[y * winWidth * 4],
-			&data.pixels[(winHeight - 1 - y) * winWidth * 4],
-			winWidth * 4
-		);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glPopAttrib();
+}
+
+// Back to where the frame ends up: the window, or our offscreen target.
+void Renderer::RendererGL21::BindOutput() {
+	if (!GLExt::HasFramebuffers()) {
+		return;
+	}
+	if (output == GLOutput::Window) {
+		GLOffscreenTarget::Unbind();
+	} else {
+		offscreen.Bind();
 	}
-	data.pixels = std::move(flipped);
-	return data;
 }
 
+void Renderer::RendererGL21::ReleaseSceneTarget() {
+	sceneTarget.Release();
+	sceneTimer.Release();
+	if (sceneTexture) {
+		glDeleteTextures(1, &sceneTexture);
+		sceneTexture = 0;
+	}
+	sceneGpuMs = 0.0f;
+	resolutionController.Reset();
+}
+
+Renderer::RendererGL21::~RendererGL21() {
+	// a hosted renderer's GL objects went with DetachHost
+	if (glReady && output != GLOutput::Hosted) {
+		ReleaseGL();
+	}
+	if (window) {
+		glfwDestroyWindow(window);
+		window = nullptr;
+	}
+	if (glfwStarted) {
+		glfwTerminate();
+		glfwStarted = false;
+	}
+}
+
+// Offscreen, only the size is recorded here; the attachments are
+// reallocated on the GL thread at the start of the next frame. A hosted
+// renderer that draws into the host's texture takes its size from there.
 void Renderer::RendererGL21::setSize(int newWidth, int newHeight) {
+	if (output != GLOutput::Window) {
+		if (!offscreen.External()) {
+			winWidth  = (std::max)(1, newWidth);
+			winHeight = (std::max)(1, newHeight);
+		}
+		return;
+	}
 	glfwSetWindowSize(window, newWidth, newHeight);
 }
 
-void Renderer::RendererGL21::RenderFrame() {
-	if (!window) return;
+// Runs on the thread that created the window: GLFW only allows event
+// polling and input queries there.
+bool Renderer::RendererGL21::ProcessEvents() {
+	// a host pumps its own events
+	if (output == GLOutput::Hosted) return true;
+	if (!window) return false;
 
+	glfwPollEvents();
 	if (glfwWindowShouldClose(window)) {
 		Logger::Info("GLFW window requested close; exiting.");
-		glfwDestroyWindow(window);
-		glfwTerminate();
-		exit(0);
+		return false;
 	}
 
 	// ESC unlocks cursor
@@ -515,16 +913,63 @@ void Renderer::RendererGL21::RenderFrame() {
 	if (glfwMouseCaptured) {
 		runtime->ProcessInput(window, dt);
 	}
+	return true;
+}
+
+bool Renderer::RendererGL21::MakeCurrent(bool current) {
+	if (!window) return false;
+	glfwMakeContextCurrent(current ? window : nullptr);
+	return true;
+}
+
+void Renderer::RendererGL21::RenderFrame() {
+	if (!glReady) return;
+	double frameStart = glfwGetTime();
 	cam->updateForFrame();
 
+	if (output == GLOutput::Hosted) {
+		SaveHostState();
+		SetFrameState();
+	}
+	if (output != GLOutput::Window && !offscreen.External()
+		&& (offscreen.Width() != winWidth || offscreen.Height() != winHeight)) {
+		if (!offscreen.Resize(winWidth, winHeight)) {
+			Logger::Error("Could not resize the offscreen target.");
+			if (output == GLOutput::Hosted) RestoreHostState();
+			return;
+		}
+	}
+	if (output != GLOutput::Window) {
+		offscreen.Bind();
+	}
+	// the size callback runs on the event thread, which may not own the context
+	int outputWidth  = winWidth;
+	int outputHeight = winHeight;
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	// finished texture loads, a budgeted slice per frame
+	TextureManager::ProcessUploads(*this);
+
+	lodStats = LodStats();
+	frameStats = FrameStats();
+
+	// with dynamic resolution on, the scene goes to a scaled target first
+	int  sceneWidth  = outputWidth;
+	int  sceneHeight = outputHeight;
+	bool scaled = BeginScaledScene(outputWidth, outputHeight, sceneWidth, sceneHeight);
+
 	// clear & draw
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// setup projection
-	float aspect = float(winWidth) / float(winHeight);
-	glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
+	float aspect = float(outputWidth) / float(outputHeight);
+	glm::mat4 proj = glm::perspective(glm::radians(Camera::FieldOfView), aspect, NearPlane, FarPlane);
 	proj[2][2] = proj[2][2] * 0.5f + proj[3][2] * 0.5f;
 	proj[3][2] = proj[3][2] * 0.5f;
+	if (output == GLOutput::Hosted) {
+		// the host samples the texture top row first
+		proj = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f)) * proj;
+	}
 	glMatrixMode(GL_PROJECTION);
 	glLoadMatrixf(glm::value_ptr(proj));
 
@@ -552,49 +997,170 @@ void Renderer::RendererGL21::RenderFrame() {
 
 	int selectedMesh = EditorPanels::GetSelectedMeshIndex();
 
-	// draw meshes
-	for (size_t i = 0; i < meshes.size(); ++i) {
-    const auto& mesh = meshes[i];
+	// pixels per world unit at distance 1, for picking LODs; a scaled-down
+	// scene has fewer pixels to spend, so coarser LODs kick in sooner
+	float lodPixelScale = sceneHeight / (2.0f * tanf(glm::radians(Camera::FieldOfView) * 0.5f));
+	float lodMaxError   = LodPixelError * exp2f(lodBias);
 
-		if (!mesh) {
+	// resolve buffers and refresh bounds for every slot before culling;
+	// geometry swapped without an UpdateMesh (e.g. an async load) is picked up here
+	if (meshBuffers.size() < meshes.size()) {
+		meshBuffers.resize(meshes.size());
+	}
+	culler.Resize(meshes.size());
+	for (size_t i = 0; i < meshes.size(); ++i) {
+		const auto& mesh = meshes[i];
+		if (batcher.Update(i, mesh)) {
+			meshBuffers[i] = nullptr;
+			culler.Update(i, nullptr, Transform());
 			continue;
 		}
+		if (mesh && mesh->geometry && (!meshBuffers[i] || meshBuffers[i]->source != mesh->geometry)) {
+			meshBuffers[i] = BuffersFor(mesh->geometry);
+		}
+		bool drawable = mesh && mesh->geometry && meshBuffers[i];
+		culler.Update(i, drawable ? mesh->geometry.get() : nullptr, drawable ? mesh->transform : Transform());
+	}
+	
+	// only the cells a static mesh moved in or out of are re-merged
+	batcher.Rebuild();
+	const std::vector<StaticBatcher::Batch>& batches = batcher.Batches();
+	batchBuffers.resize(batches.size());
+	batchCuller.Resize(batches.size());
+	for (size_t b = 0; b < batches.size(); ++b) {
+		const auto& batch = batches[b].mesh;
+		if (!batch) {
+			batchBuffers[b] = nullptr;
+		} else if (!batchBuffers[b] || batchBuffers[b]->source != batch->geometry) {
+			batchBuffers[b] = GLMeshBuffers::Create(batch->geometry, GLExt::HasVertexBuffers());
+		}
+		bool drawable = batch && batchBuffers[b];
+		batchCuller.Update(b, drawable ? batch->geometry.get() : nullptr, drawable ? batch->transform : Transform());
+	}
+	
+	FrustumCuller::Planes planes = FrustumCuller::ExtractPlanes(proj * view);
+	visibleMeshes.clear();
+	culler.Cull(planes, visibleMeshes);
+	visibleBatches.clear();
+	batchCuller.Cull(planes, visibleBatches);
+	frameStats.meshesTested = culler.Tested() + batchCuller.Tested();
+	frameStats.meshesCulled = culler.Culled() + batchCuller.Culled();
+	
+	// key every visible draw by pass, texture, buffer and depth, then sort
+	glm::vec3 viewPos     = cam->transform.position;
+	glm::vec3 viewForward = glm::normalize(cam->lookAtPosition - cam->transform.position);
+	renderQueue.Clear();
+	for (uint32_t i : visibleMeshes) {
+		float depth = glm::dot(culler.Center(i) - viewPos, viewForward) / FarPlane;
+		renderQueue.Push(RenderQueue::MakeKey(RenderQueue::Pass_Opaque, MaterialKey(*meshes[i], *meshBuffers[i]), meshBuffers[i]->id, depth), i);
+	}
+	for (uint32_t b : visibleBatches) {
+		float depth = glm::dot(batchCuller.Center(b) - viewPos, viewForward) / FarPlane;
+		renderQueue.Push(RenderQueue::MakeKey(RenderQueue::Pass_Opaque, MaterialKey(*batches[b].mesh, *batchBuffers[b]), batchBuffers[b]->id, depth), b | BatchDraw);
+	}
+	if (sortDraws) {
+		renderQueue.Sort();
+	}
+
+	// draw meshes
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	const GLMeshBuffers* bound = nullptr;
+	GLuint boundTexture = 0;
+	auto drawMesh = [&](const Mesh& mesh, const GLMeshBuffers& buffers) {
+		if (&buffers != bound) {
+			buffers.Bind();
+			bound = &buffers;
+			frameStats.stateChanges++;
+		} else {
+			frameStats.redundantStateChanges++;
+		}
+
+		// packed texcoords are half floats, which fixed function can't read
+		GLuint texture = (mesh.texture && mesh.texture->Ready() && !buffers.packed) ? GLuint(mesh.texture->Handle()) : 0;
+		if (texture != boundTexture) {
+			if (!boundTexture) {
+				glEnable(GL_TEXTURE_2D);
+				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			}
+			if (texture) {
+				glBindTexture(GL_TEXTURE_2D, texture);
+			} else {
+				glDisable(GL_TEXTURE_2D);
+				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			}
+			boundTexture = texture;
+		}
+		
+		const MeshGeometry& geometry = *mesh.geometry;
 		
 		glPushMatrix();
-		glTranslatef(mesh->transform.position.x, mesh->transform.position.y, mesh->transform.position.z);
+		glTranslatef(mesh.transform.position.x, mesh.transform.position.y, mesh.transform.position.z);
 		
-		glRotatef(mesh->transform.rotation.y, 0.0f, 1.0f, 0.0f); // Yaw (Y-axis)
-		glRotatef(mesh->transform.rotation.x, 1.0f, 0.0f, 0.0f); // Pitch (X-axis)
-		glRotatef(mesh->transform.rotation.z, 0.0f, 0.0f, 1.0f); // Roll (Z-axis)
+		glRotatef(mesh.transform.rotation.y, 0.0f, 1.0f, 0.0f); // Yaw (Y-axis)
+		glRotatef(mesh.transform.rotation.x, 1.0f, 0.0f, 0.0f); // Pitch (X-axis)
+		glRotatef(mesh.transform.rotation.z, 0.0f, 0.0f, 1.0f); // Roll (Z-axis)
 		
-		glBegin(GL_TRIANGLES);
+		size_t lod = mesh.SelectLod(cam->transform.position, lodPixelScale, lodMaxError);
+		lodStats.Record(lod, geometry);
 		
-		for (const auto& v : mesh->vertices) {
-		  glNormal3f(v.normal.x, v.normal.y, v.normal.z);
-		  glVertex3f(v.position.x, v.position.y, v.position.z);
+		if (geometry.IsPacked()) {
+			// positions go to GL as the raw snorm16 values with the dequantization
+			// in the modelview; the buffer's normals are pre-scaled by it so the
+			// inverse transpose cancels out and GL_NORMALIZE restores unit length
+			glMultMatrixf(glm::value_ptr(geometry.DequantizeMatrix()));
 		}
 		
-		glEnd();
+		buffers.Draw(lod);
+		frameStats.drawCalls++;
+		frameStats.triangles += static_cast<uint32_t>(geometry.LodIndices(lod).size() / 3);
 		
 		glPopMatrix();
+	};
+	for (const RenderQueue::Item& item : renderQueue.Items()) {
+		uint32_t i = item.index & ~BatchDraw;
+		if (item.index & BatchDraw) {
+			drawMesh(*batches[i].mesh, *batchBuffers[i]);
+		} else {
+			drawMesh(*meshes[i], *meshBuffers[i]);
+		}
+	}
+	GLMeshBuffers::Unbind();
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	if (boundTexture) {
+		glDisable(GL_TEXTURE_2D);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
 
-		// Only draw arrows if we're in the Editor
-		if (dynamic_cast<Runtime::EditorRuntime*>(runtime) != nullptr
-            && i == selectedMesh)
-        {
-            // save GL state
-            glPushAttrib(GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_LIGHTING_BIT | GL_POLYGON_BIT);
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(GL_FALSE);
-            glDisable(GL_LIGHTING);
-            glDisable(GL_CULL_FACE);
+	// Only draw arrows if we're in the Editor; they stay on top, culled mesh or not
+	if (dynamic_cast<Runtime::EditorRuntime*>(runtime) != nullptr
+		&& selectedMesh >= 0 && selectedMesh < int(meshes.size()) && meshes[selectedMesh])
+	{
+		AddArrowGizmos(debugDraw, meshes[selectedMesh]->transform.position, /*scale=*/0.5f);
+	}
+	frameStats.debugVertices  = static_cast<uint32_t>(debugDraw.VertexCount());
+	frameStats.debugDrawCalls = debugRenderer.Draw(debugDraw);
 
-            DrawArrowGizmos(mesh->transform.position, /*scale=*/0.5f);
+	if (scaled) {
+		EndScaledScene(outputWidth, outputHeight, sceneWidth, sceneHeight);
+	}
 
-            // restore
-            glPopAttrib();
-        }
+	// read back before presenting; the back buffer is undefined after the swap
+	if (captureRequested) {
+		readback.Queue(outputWidth, outputHeight, output == GLOutput::Hosted);
+	}
+	frameStats.readbackStallMs = readback.StallMs();
+
+	frameStats.cpuMs = static_cast<float>((glfwGetTime() - frameStart) * 1000.0);
+	if (output == GLOutput::Hosted) {
+		// the host presents; its next draw picks the texture up
+		RestoreHostState();
+	} else if (output == GLOutput::Headless) {
+		// nothing to present; just keep the driver moving
+		glFlush();
+	} else {
+		glfwSwapBuffers(window);
 	}
-	glfwSwapBuffers(window);
-	glfwPollEvents();
 }
\ No newline at end of file
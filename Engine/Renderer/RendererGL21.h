@@ -4,24 +4,101 @@
 #include "IRenderer.h"
 #include "Mesh.h"
 #include "Renderer/Camera.h"
+#include "GLMeshBuffers.h"
+#include "GLFrameReadback.h"
+#include "GLDebugDraw.h"
+#include "GLOffscreenTarget.h"
+#include "GLFrameTimer.h"
+#include "FrustumCuller.h"
+#include "StaticBatcher.h"
+#include "RenderQueue.h"
 #include <memory>           // for std::shared_ptr
+#include <unordered_map>
 
 namespace Renderer {
 	class RendererGL21 : public IRenderer {
 	public:
+		explicit RendererGL21(GLOutput output = GLOutput::Window) : output(output) {}
+		~RendererGL21() override;
 		bool Init(Camera *cam, Runtime::Runtime *runtime) override;
+		bool ProcessEvents() override;
 		void RenderFrame() override;
+		bool MakeCurrent(bool current) override;
 		bool SetMeshes(std::vector<std::shared_ptr<Mesh>> msh) override;
 		bool UpdateMesh(int indx, std::shared_ptr<Mesh> msh) override;
 		bool DeleteMesh(int indx) override;
 		int AddMesh(std::shared_ptr<Mesh> mesh) override;
+		bool UpdateTransform(int indx, const Transform& transform) override;
+		bool UpdateGeometryRange(int indx, size_t first, size_t count) override;
 		
-		ImageData CaptureFrame() override;
+		const ImageData& CaptureFrame() override;
 		void setSize(int newWidth, int newHeight);
+
+		uintptr_t CreateTexture(int width, int height, int mipCount, PixelFormat format) override;
+		bool UploadTextureLevel(uintptr_t texture, int level, int width, int height, const uint8_t* data, size_t size) override;
+		void DeleteTexture(uintptr_t texture) override;
+
+		// Hosted only. The host's context must be current on this thread
+		// for all of these, and for every RenderFrame. AttachHost loads GL
+		// through the host's `getProcAddress` and sets up our state in its
+		// context; when that fails, CreateOwnContext turns the renderer
+		// into a headless one instead.
+		bool AttachHost(GLExt::ProcLoader getProcAddress);
+		bool CreateOwnContext();
+		// Frames go into `texture` (a GL_TEXTURE_2D or rectangle texture of
+		// the host's) from now on; 0 draws into a renderbuffer of our own.
+		bool SetHostTarget(GLuint texture, GLenum target, int width, int height);
+		// The same for whichever texture the host has bound right now, a
+		// rectangle one or a 2D one.
+		bool SetHostTargetFromBinding(bool rectangle, int width, int height);
+		// Frees our GL objects while the host's context still exists.
+		void DetachHost();
+		GLOutput Output() const { return output; }
 	private:
 		std::vector<std::shared_ptr<Mesh>> meshes;
+		std::vector<std::shared_ptr<GLMeshBuffers>> meshBuffers;
+		std::unordered_map<const MeshGeometry*, std::weak_ptr<GLMeshBuffers>> geometryBuffers;
+		FrustumCuller                      culler;
+		std::vector<uint32_t>              visibleMeshes;
+		// merged static meshes, one buffer set per StaticBatcher batch
+		StaticBatcher                      batcher;
+		std::vector<std::shared_ptr<GLMeshBuffers>> batchBuffers;
+		FrustumCuller                      batchCuller;
+		std::vector<uint32_t>              visibleBatches;
+		RenderQueue                        renderQueue;
+		// internal format of each block-compressed texture, by name
+		std::unordered_map<GLuint, GLenum> compressedTextures;
+		GLDebugDraw                        debugRenderer;
+		// frames are only read back once someone has asked for one
+		GLFrameReadback                    readback;
+		ImageData                          capture;
+		bool                               captureRequested = false;
+		GLOutput                           output;
+		GLOffscreenTarget                  offscreen;
+		bool                               glReady = false;
+		GLint                              hostFramebuffer = 0;
+		bool                               hostRectangles  = false;
+		// dynamic resolution: the scene is drawn into a corner of sceneTexture,
+		// sized for the largest scale allowed, then stretched over the output
+		GLOffscreenTarget                  sceneTarget;
+		GLuint                             sceneTexture = 0;
+		GLFrameTimer                       sceneTimer;
+		float                              sceneGpuMs   = 0.0f;
+		bool                               sceneTargetFailed = false;
 		Runtime::Runtime*                  runtime;
+		bool InitGLFW();
+		bool CreateContext();
+		bool InitGLState();
+		void SetFrameState();
+		void SaveHostState();
+		void RestoreHostState();
+		void ReleaseGL();
+		bool BeginScaledScene(int outputWidth, int outputHeight, int& sceneWidth, int& sceneHeight);
+		void EndScaledScene(int outputWidth, int outputHeight, int sceneWidth, int sceneHeight);
+		void BindOutput();
+		void ReleaseSceneTarget();
 		void CreateSkyboxTexture(const char* filename);
+		std::shared_ptr<GLMeshBuffers> BuffersFor(const std::shared_ptr<const MeshGeometry>& geometry);
 		
 		float skybox_r = 0.0;
 		float skybox_g = 0.0;
@@ -5,8 +5,11 @@
 #include "Mesh.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <iterator>
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace Renderer {
 	// Static member definitions
@@ -15,11 +18,32 @@ namespace Renderer {
 	IRenderer*        RendererManager::rendererGL         = nullptr;
 	Camera*           RendererManager::cam                = new Camera();
 	Runtime::Runtime* RendererManager::runtime            = nullptr;
+	IRenderer*        RendererManager::active             = nullptr;
+	const char*       RendererManager::activeName         = "";
+	CommandBuffer     RendererManager::frameCommands;
+	CommandBuffer     RendererManager::lastFrameCommands;
+	std::vector<DebugText> RendererManager::frameTexts;
+	bool              RendererManager::useRenderThread    = false;
+	GLOutput          RendererManager::glOutput           = GLOutput::Window;
+	RenderThread*     RendererManager::renderThread       = nullptr;
+	std::vector<std::shared_ptr<Mesh>> RendererManager::sceneMeshes;
+	CommandBuffer     RendererManager::stagedCommands;
+	uint64_t          RendererManager::frameIndex         = 0;
+	std::vector<RendererManager::EditedGeometry> RendererManager::editedGeometry;
+	std::vector<GeometryEdit> RendererManager::stagedEdits;
 
 	void RendererManager::SelectRenderer(RendererType type) {
 		s_selectedRenderer = type;
 	}
 
+	void RendererManager::UseRenderThread(bool use) {
+		useRenderThread = use;
+	}
+
+	void RendererManager::SetGLOutput(GLOutput output) {
+		glOutput = output;
+	}
+
 	bool RendererManager::InitRenderer(Runtime::Runtime *runtime) {
 		// Initialize camera
 		cam->transform.position = glm::vec3(0.0f, 1.0f, 5.0f);
@@ -41,7 +65,7 @@ namespace Renderer {
 			}
 		} else if (s_selectedRenderer == RendererType::OpenGL21) {
 			Logger::Info("Initializing OpenGL 2.1 renderer...");
-			rendererGL = new RendererGL21();
+			rendererGL = new RendererGL21(glOutput);
 			if (rendererGL->Init(cam, runtime)) {
 				Logger::Info("OpenGL 2.1 renderer initialized.");
 				success = true;
@@ -57,89 +81,291 @@ namespace Renderer {
 			return false;
 		}
 
+		active     = rendererDX9 ? rendererDX9 : rendererGL;
+		activeName = rendererDX9 ? "DirectX 9" : "OpenGL 2.1";
+
+		if (useRenderThread) {
+			if (active->MakeCurrent(false)) {
+				renderThread = new RenderThread();
+				renderThread->Start(active);
+				Logger::Info(std::string("Rendering ") + activeName + " on a dedicated thread.");
+			} else {
+				Logger::Warn(std::string(activeName) + " can't render from another thread; rendering on the main thread.");
+			}
+		}
+
 		return true;
 	}
 	
 	bool RendererManager::SetMeshes(std::vector<std::shared_ptr<Mesh>> meshes) {
-		// Assign meshes to the active renderer
-		if (rendererDX9) {
-			if (rendererDX9->SetMeshes(meshes)) {
-				Logger::Info("Loaded meshes for DirectX 9");
-				return true;
-			} else {
-				Logger::Error("Could not load meshes for DirectX 9");
-				return false;
-			}
-		}else if (rendererGL) {
-			if (rendererGL->SetMeshes(meshes)) {
-				Logger::Info("Loaded meshes for OpenGL 2.1");
-				return true;
-			} else {
-				Logger::Error("Could not load meshes for OpenGL 2.1");
-				return false;
-			}
-		}else{
+		if (!active) {
 			return false;
 		}
+		// replaces every slot, so earlier recorded commands must land first
+		FlushCommands();
+		if (renderThread) {
+			sceneMeshes = std::move(meshes);
+			editedGeometry.clear();
+			stagedEdits.clear();
+			Logger::Info(std::string("Loaded meshes for ") + activeName);
+			return true;
+		}
+		if (active->SetMeshes(meshes)) {
+			Logger::Info(std::string("Loaded meshes for ") + activeName);
+			return true;
+		}
+		Logger::Error(std::string("Could not load meshes for ") + activeName);
+		return false;
 	}
 	
+	// The per-slot updates below are recorded on the calling thread and
+	// applied by the renderer at the start of the next RenderFrame.
 	bool RendererManager::UpdateMesh(int indx, std::shared_ptr<Mesh> mesh) {
-		// printf("Updated mesh\n");
-		if (rendererDX9) {
-			if (rendererDX9->UpdateMesh(indx, mesh)) {
-				return true;
-			} else {
-				return false;
-			}
-		}else if (rendererGL) {
-			if (rendererGL->UpdateMesh(indx, mesh)) {
-				return true;
-			} else {
-				return false;
-			}
-		}else{
-			return false;
-		}
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.SetMesh(indx, std::move(mesh)); });
+		return active != nullptr;
+	}
+	
+	bool RendererManager::UpdateTransform(int indx, const Transform& transform) {
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.SetTransform(indx, transform); });
+		return active != nullptr;
+	}
+	
+	bool RendererManager::UpdateGeometryRange(int indx, size_t first, size_t count) {
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.UpdateRange(indx, first, count); });
+		return active != nullptr;
 	}
 	
 	bool RendererManager::DeleteMesh(int indx) {
-		if (rendererDX9) {
-			if (rendererDX9->DeleteMesh(indx)) {
-				return true;
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.DeleteMesh(indx); });
+		return active != nullptr;
+	}
+	
+	int RendererManager::AddMesh(std::shared_ptr<Mesh> mesh) {
+		if (!active) {
+			return -1;
+		}
+		// the free slot has to be picked with pending deletes applied
+		FlushCommands();
+		if (renderThread) {
+			// same policy as the renderers: first free slot, else a new one
+			auto free = std::find(sceneMeshes.begin(), sceneMeshes.end(), nullptr);
+			int indx = static_cast<int>(free - sceneMeshes.begin());
+			if (free == sceneMeshes.end()) {
+				sceneMeshes.push_back(std::move(mesh));
 			} else {
-				return false;
+				*free = std::move(mesh);
 			}
-		}else if (rendererGL) {
-			if (rendererGL->DeleteMesh(indx)) {
-				return true;
-			} else {
-				return false;
+			return indx;
+		}
+		return active->AddMesh(mesh);
+	}
+
+	void RendererManager::SetLodBias(float bias) {
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.SetLodBias(bias); });
+	}
+
+	void RendererManager::SetSortDraws(bool sort) {
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.SetSortDraws(sort); });
+	}
+
+	void RendererManager::SetDynamicResolution(const DynamicResolutionSettings& settings) {
+		RenderCommands::Record([&](CommandBuffer& commands) { commands.SetDynamicResolution(settings); });
+	}
+
+	LodStats RendererManager::GetLodStats() {
+		if (renderThread) return renderThread->GetLodStats();
+		return active ? active->lodStats : LodStats();
+	}
+
+	FrameStats RendererManager::GetFrameStats() {
+		if (renderThread) return renderThread->GetFrameStats();
+		return active ? active->frameStats : FrameStats();
+	}
+
+	void RendererManager::GetResolutionHistory(std::vector<DynamicResolution::Sample>& out) {
+		if (renderThread) {
+			renderThread->GetResolutionHistory(out);
+		} else if (active) {
+			active->resolutionController.CopyHistory(out);
+		} else {
+			out.clear();
+		}
+	}
+
+	const CommandBuffer& RendererManager::LastFrameCommands() {
+		return lastFrameCommands;
+	}
+
+	const std::vector<DebugText>& RendererManager::FrameTexts() {
+		return frameTexts;
+	}
+
+	void RendererManager::FlushCommands() {
+		CommandBuffer pending;
+		RenderCommands::Flush(pending);
+		if (pending.Empty()) {
+			return;
+		}
+		if (renderThread) {
+			ApplyToScene(pending);
+		} else if (active) {
+			size_t failed = pending.Replay(*active);
+			if (failed) {
+				Logger::Warn(std::to_string(failed) + " render commands failed");
 			}
-		}else{
-			return false;
 		}
+		frameCommands.Append(pending);
 	}
-	
-	int RendererManager::AddMesh(std::shared_ptr<Mesh> mesh) {
-		if (rendererDX9) {
-			return rendererDX9->AddMesh(mesh);
-		}else if (rendererGL) {
-			return rendererGL->AddMesh(mesh);
-		}else{
-			return -1;
+
+	// Slot changes land in sceneMeshes, as the renderer would have applied
+	// them; everything else waits for the next snapshot.
+	void RendererManager::ApplyToScene(const CommandBuffer& commands) {
+		for (const RenderCommand& command : commands.Commands()) {
+			size_t slot = static_cast<size_t>(command.slot);
+			switch (command.type) {
+				case RenderCommandType::SetMesh:
+					if (slot >= sceneMeshes.size()) {
+						sceneMeshes.resize(slot + 1);
+					}
+					sceneMeshes[slot] = commands.MeshOf(command);
+					if (slot < editedGeometry.size()) {
+						editedGeometry[slot] = EditedGeometry();
+					}
+					break;
+				case RenderCommandType::SetTransform:
+					if (slot < sceneMeshes.size() && sceneMeshes[slot]) {
+						sceneMeshes[slot]->transform = CommandBuffer::TransformOf(command);
+					}
+					break;
+				case RenderCommandType::DeleteMesh:
+					if (slot < sceneMeshes.size()) {
+						sceneMeshes[slot] = nullptr;
+					}
+					if (slot < editedGeometry.size()) {
+						editedGeometry[slot] = EditedGeometry();
+					}
+					break;
+				case RenderCommandType::UpdateRange:
+					// the game may go on editing these vertices while the
+					// render thread reads them, so it never gets the game's
+					if (slot < sceneMeshes.size() && sceneMeshes[slot] && sceneMeshes[slot]->geometry) {
+						if (slot >= editedGeometry.size()) {
+							editedGeometry.resize(slot + 1);
+						}
+						EditedGeometry& edited = editedGeometry[slot];
+						const MeshGeometry& geometry = *sceneMeshes[slot]->geometry;
+						if (edited.source != sceneMeshes[slot]->geometry) {
+							// the first edit hands over a whole copy, uploaded once
+							edited.source = sceneMeshes[slot]->geometry;
+							edited.copy   = std::make_shared<MeshGeometry>(geometry);
+							edited.copy->ComputeBounds();
+							break;
+						}
+						size_t first = std::min(size_t(command.first), geometry.VertexCount());
+						size_t last  = std::min(first + size_t(command.count), geometry.VertexCount());
+						GeometryEdit range;
+						range.target = edited.copy;
+						range.first  = first;
+						if (geometry.IsPacked()) {
+							range.packed.assign(geometry.packed.begin() + first, geometry.packed.begin() + last);
+						} else {
+							range.vertices.assign(geometry.vertices.begin() + first, geometry.vertices.begin() + last);
+						}
+						stagedEdits.push_back(std::move(range));
+						stagedCommands.UpdateRange(command.slot, first, last - first);
+					}
+					break;
+				case RenderCommandType::SetLodBias:
+					stagedCommands.SetLodBias(command.values[0]);
+					break;
+				case RenderCommandType::SetSortDraws:
+					stagedCommands.SetSortDraws(command.ref != 0);
+					break;
+				case RenderCommandType::SetDynamicResolution:
+					stagedCommands.SetDynamicResolution(CommandBuffer::DynamicResolutionOf(command));
+					break;
+			}
+		}
+	}
+
+	void RendererManager::PublishSnapshot() {
+		FrameSnapshot& snapshot = renderThread->Back();
+		snapshot.frame        = frameIndex++;
+		snapshot.camera       = cam->transform;
+		snapshot.cameraLookAt = cam->lookAtPosition;
+		snapshot.slots.resize(sceneMeshes.size());
+		for (size_t i = 0; i < sceneMeshes.size(); ++i) {
+			SlotSnapshot& slot = snapshot.slots[i];
+			const Mesh* mesh = sceneMeshes[i].get();
+			slot.geometry = mesh ? mesh->geometry : nullptr;
+			if (slot.geometry && i < editedGeometry.size() && editedGeometry[i].source == slot.geometry) {
+				slot.geometry = editedGeometry[i].copy;
+			}
+			if (mesh) {
+				slot.transform   = mesh->transform;
+				slot.is_castable = mesh->is_castable;
+				slot.is_static   = mesh->is_static;
+				slot.texture     = mesh->texture;
+			} else {
+				slot.texture     = nullptr;
+			}
 		}
+		snapshot.edits.insert(snapshot.edits.end(),
+							  std::make_move_iterator(stagedEdits.begin()), std::make_move_iterator(stagedEdits.end()));
+		stagedEdits.clear();
+		snapshot.commands.Append(stagedCommands);
+		stagedCommands.Clear();
+		DebugDraw::Flush(snapshot.debugDraw);
+		frameTexts = snapshot.debugDraw.Texts();
+		renderThread->Publish();
 	}
 
-	void RendererManager::RenderFrame() {
+	bool RendererManager::RenderFrame() {
+		if (!active) {
+			return false;
+		}
+		if (!active->ProcessEvents()) {
+			return false;
+		}
 		cam->updateForFrame();
-		if (rendererDX9) rendererDX9->RenderFrame();
-		if (rendererGL)  rendererGL->RenderFrame();
+		FlushCommands();
+		lastFrameCommands.Swap(frameCommands);
+		frameCommands.Clear();
+		if (renderThread) {
+			PublishSnapshot();
+		} else {
+			DebugDraw::Flush(active->debugDraw);
+			frameTexts = active->debugDraw.Texts();
+			active->RenderFrame();
+		}
+		return true;
 	}
 
 	void RendererManager::Shutdown() {
+		if (renderThread) {
+			renderThread->Stop();
+			delete renderThread;
+			renderThread = nullptr;
+			// the renderer tears its resources down from this thread
+			active->MakeCurrent(true);
+			active->cam = cam;
+		}
+		CommandBuffer dropped;
+		RenderCommands::Flush(dropped);
+		DebugDrawList droppedDebug;
+		DebugDraw::Flush(droppedDebug);
+		frameCommands.Clear();
+		lastFrameCommands.Clear();
+		frameTexts.clear();
+		stagedCommands.Clear();
+		sceneMeshes.clear();
+		editedGeometry.clear();
+		stagedEdits.clear();
+
 		delete rendererDX9;
 		delete rendererGL;
 		rendererDX9 = nullptr;
 		rendererGL  = nullptr;
+		active      = nullptr;
 	}
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #pragma once
 
 #include "IRenderer.h"
+#include "RenderCommands.h"
+#include "RenderThread.h"
 #include "Camera.h"
 #include "../Core/Runtime.h"
 
@@ -16,23 +18,86 @@ namespace Renderer {
 		// call this once, before InitRenderer
 		static void SelectRenderer(RendererType type);
 		
+		// call before InitRenderer: draw on a dedicated thread one frame
+		// behind the simulation, if the chosen renderer can hand its context
+		// over. Slot and camera state are snapshotted at the end of each
+		// RenderFrame, so the game may keep changing its meshes meanwhile.
+		// The first UpdateGeometryRange on a slot gives the render thread a
+		// copy of that geometry; later ones send just the edited vertices.
+		static void UseRenderThread(bool use);
+		// call before InitRenderer: where OpenGL draws (see GLOutput)
+		static void SetGLOutput(GLOutput output);
+
 		// only inits the chosen renderer
 		static bool InitRenderer(Runtime::Runtime *runtime);
 
-		static void RenderFrame();
+		// Polls window events and input, then draws (or hands the frame to
+		// the render thread). Returns false once the window asked to close.
+		static bool RenderFrame();
 		static void Shutdown();
+		// SetMeshes and AddMesh apply immediately (AddMesh has to return the
+		// slot). The rest are recorded into the calling thread's command
+		// buffer, may be called from any thread, and reach the renderer at
+		// the start of the next RenderFrame; they return false only when no
+		// renderer is up.
 		static bool SetMeshes(std::vector<std::shared_ptr<Mesh>> msh);
 		static bool UpdateMesh(int indx, std::shared_ptr<Mesh> msh);
 		static bool DeleteMesh(int indx);
 		static int AddMesh(std::shared_ptr<Mesh> mesh);
+		static bool UpdateTransform(int indx, const Transform& transform);
+		static bool UpdateGeometryRange(int indx, size_t first, size_t count);
+
+		static void SetLodBias(float bias);
+		static void SetSortDraws(bool sort);
+		static LodStats GetLodStats();
+		static FrameStats GetFrameStats();
+		// Scene render scale between bounds, held to a GPU time budget (GL 2.1
+		// only). The current scale is in GetFrameStats; the controller's recent
+		// samples, oldest first, come from GetResolutionHistory.
+		static void SetDynamicResolution(const DynamicResolutionSettings& settings);
+		static void GetResolutionHistory(std::vector<DynamicResolution::Sample>& out);
+
+		// Applies every thread's recorded commands to the renderer now.
+		static void FlushCommands();
+		// What the last frame replayed, for dumping, diffing or replaying again.
+		static const CommandBuffer& LastFrameCommands();
+		// The labels DebugDraw::Text recorded for the last frame. The
+		// renderers don't draw text; the editor puts these over its view.
+		static const std::vector<DebugText>& FrameTexts();
 
 		static Camera*           cam;
 		
 		static IRenderer*        rendererDX9;
 		static IRenderer*        rendererGL;
+		static IRenderer*        active;   // whichever of the two is up
 		
 	private:
 		static RendererType      s_selectedRenderer;
 		static Runtime::Runtime* runtime;
+		static const char*       activeName;
+		static CommandBuffer     frameCommands;
+		static CommandBuffer     lastFrameCommands;
+		static std::vector<DebugText> frameTexts;
+
+		// render thread mode: the game's view of every slot, and what the
+		// next snapshot still has to replay
+		static bool                               useRenderThread;
+		static GLOutput                           glOutput;
+		static RenderThread*                      renderThread;
+		static std::vector<std::shared_ptr<Mesh>> sceneMeshes;
+		static CommandBuffer                      stagedCommands;
+		static uint64_t                           frameIndex;
+		// geometry the game edits in place (UpdateGeometryRange) is never
+		// shared with the render thread: snapshots carry a copy that only
+		// the render thread writes to, and the edited ranges to apply to it
+		struct EditedGeometry {
+			std::shared_ptr<const MeshGeometry> source;   // the game's
+			std::shared_ptr<MeshGeometry>       copy;
+		};
+		static std::vector<EditedGeometry>        editedGeometry;   // by slot
+		static std::vector<GeometryEdit>          stagedEdits;
+
+		static void ApplyToScene(const CommandBuffer& commands);
+		static void PublishSnapshot();
 	};
 }
@@ -0,0 +1,172 @@
+#include "StaticBatcher.h"
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Renderer;
+
+namespace {
+	// 21 bits per axis is plenty for any cell index a float position can reach
+	uint64_t PackCell(const glm::ivec3& cell) {
+		const uint64_t mask = (1u << 21) - 1;
+		return (uint64_t(cell.x) & mask) | ((uint64_t(cell.y) & mask) << 21) | ((uint64_t(cell.z) & mask) << 42);
+	}
+}
+
+size_t StaticBatcher::BatchKeyHash::operator()(const BatchKey& key) const {
+	return std::hash<uint64_t>()(key.cell) ^ (std::hash<const Texture*>()(key.texture) * 31);
+}
+
+bool StaticBatcher::Update(size_t slot, const std::shared_ptr<Mesh>& mesh) {
+	if (!mesh || !mesh->is_static || !mesh->geometry) {
+		if (IsBatched(slot)) {
+			Detach(slot);
+		}
+		return false;
+	}
+
+	if (slot >= slots.size()) {
+		slots.resize(slot + 1);
+	}
+	SlotState& state = slots[slot];
+	if (state.batch >= 0 && state.geometry == mesh->geometry && state.texture == mesh->texture
+		&& state.transform == mesh->transform) {
+		return true;
+	}
+
+	// the centre of the mesh's world bounds picks its cell
+	const MeshGeometry& geometry = *mesh->geometry;
+	glm::vec3 localCenter = (geometry.boundsMin + geometry.boundsMax) * 0.5f;
+	glm::vec3 center = glm::vec3(FrustumCuller::DrawMatrix(mesh->transform) * glm::vec4(localCenter, 1.0f));
+	glm::ivec3 cell(int(std::floor(center.x / cellSize)), int(std::floor(center.y / cellSize)), int(std::floor(center.z / cellSize)));
+
+	// a batch draws with one texture, so each texture gets its own per cell
+	int target = BatchFor(cell, mesh->texture);
+	if (state.batch != target) {
+		Detach(slot);
+		batches[target].members.push_back(slot);
+		state.batch = target;
+	}
+	state.geometry  = mesh->geometry;
+	state.texture   = mesh->texture;
+	state.transform = mesh->transform;
+	batches[target].dirty = true;
+	return true;
+}
+
+void StaticBatcher::Invalidate(size_t slot) {
+	if (IsBatched(slot)) {
+		batches[slots[slot].batch].dirty = true;
+	}
+}
+
+void StaticBatcher::Remove(size_t slot) {
+	if (IsBatched(slot)) {
+		Detach(slot);
+	}
+}
+
+void StaticBatcher::Clear() {
+	slots.clear();
+	batches.clear();
+	cellBatches.clear();
+}
+
+size_t StaticBatcher::Rebuild() {
+	size_t rebuilt = 0;
+	for (Batch& batch : batches) {
+		if (batch.dirty) {
+			Merge(batch);
+			++rebuilt;
+		}
+	}
+	return rebuilt;
+}
+
+// Batch indices are stable: a cell keeps its entry after it empties, so
+// renderers can key per-batch buffers by index.
+int StaticBatcher::BatchFor(const glm::ivec3& cell, const std::shared_ptr<Texture>& texture) {
+	BatchKey key{ PackCell(cell), texture.get() };
+	auto found = cellBatches.find(key);
+	if (found != cellBatches.end()) {
+		return found->second;
+	}
+	int index = static_cast<int>(batches.size());
+	batches.emplace_back();
+	batches.back().cell    = cell;
+	batches.back().texture = texture;
+	cellBatches[key] = index;
+	return index;
+}
+
+void StaticBatcher::Detach(size_t slot) {
+	SlotState& state = slots[slot];
+	if (state.batch >= 0) {
+		Batch& batch = batches[state.batch];
+		batch.members.erase(std::remove(batch.members.begin(), batch.members.end(), slot), batch.members.end());
+		batch.dirty = true;
+	}
+	state = SlotState();
+}
+
+void StaticBatcher::Merge(Batch& batch) {
+	batch.dirty = false;
+	if (batch.members.empty()) {
+		batch.mesh = nullptr;
+		return;
+	}
+
+	// vertices are stored relative to the cell centre to keep them small
+	glm::vec3 origin = (glm::vec3(float(batch.cell.x), float(batch.cell.y), float(batch.cell.z)) + 0.5f) * cellSize;
+
+	size_t vertexCount = 0;
+	size_t levels = 1;
+	for (size_t slot : batch.members) {
+		vertexCount += slots[slot].geometry->VertexCount();
+		levels = std::max(levels, slots[slot].geometry->LodCount());
+	}
+
+	std::vector<Vertex>   vertices;
+	std::vector<uint32_t> indices;
+	std::vector<MeshLod>  lods(levels - 1);
+	vertices.reserve(vertexCount);
+
+	for (size_t slot : batch.members) {
+		const MeshGeometry& geo = *slots[slot].geometry;
+		glm::mat4 world  = FrustumCuller::DrawMatrix(slots[slot].transform);
+		glm::mat3 rotate = glm::mat3(world);
+		uint32_t  base   = static_cast<uint32_t>(vertices.size());
+
+		for (uint32_t i = 0; i < geo.VertexCount(); ++i) {
+			Vertex v;
+			v.position = glm::vec3(world * glm::vec4(geo.Position(i), 1.0f)) - origin;
+			v.normal   = rotate * geo.Normal(i);
+			v.texcoord = geo.Texcoord(i);
+			vertices.push_back(v);
+		}
+
+		// members with a shorter LOD chain repeat their coarsest level
+		for (size_t level = 0; level < levels; ++level) {
+			size_t source = std::min(level, geo.LodCount() - 1);
+			std::vector<uint32_t>& out = level == 0 ? indices : lods[level - 1].indices;
+			for (uint32_t index : geo.LodIndices(source)) {
+				out.push_back(base + index);
+			}
+			if (level > 0) {
+				lods[level - 1].error = std::max(lods[level - 1].error, geo.LodError(source));
+			}
+		}
+	}
+
+	auto geometry = std::make_shared<MeshGeometry>(std::move(vertices), std::move(indices));
+	geometry->lods = std::move(lods);
+	if (!geometry->lods.empty()) {
+		geometry->processed |= MeshLoad_Lods;
+	}
+
+	auto mesh = std::make_shared<Mesh>(std::move(geometry));
+	mesh->transform.position = origin;
+	mesh->texture     = batch.texture;
+	mesh->is_castable = false;
+	batch.mesh = std::move(mesh);
+}
@@ -0,0 +1,76 @@
+// StaticBatcher.h
+#pragma once
+
+#include "Mesh.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Renderer {
+
+// Merges the meshes flagged `is_static` into one geometry per cell of a
+// uniform world grid and texture, so level geometry costs a draw per cell
+// and material rather than one per mesh. Each batch is an ordinary Mesh (vertices relative to the
+// cell centre, translated back by its transform), so renderers cull,
+// pick LODs for and draw it like any other mesh. Moving, adding or removing
+// a static mesh only re-merges the cells it left and entered.
+class StaticBatcher {
+public:
+	struct Batch {
+		glm::ivec3               cell = glm::ivec3(0);
+		std::shared_ptr<Texture> texture;   // every member's; `mesh` draws with it
+		std::vector<size_t>      members;   // mesh slots merged into `mesh`
+		std::shared_ptr<Mesh>    mesh;      // null while the cell is empty
+		bool                     dirty = false;
+	};
+
+	explicit StaticBatcher(float cellSize = 32.0f) : cellSize(cellSize) {}
+
+	// Syncs slot `slot` with `mesh`; cheap when nothing changed, so renderers
+	// call it for every slot each frame. Returns true if the slot is batched
+	// and must not be drawn on its own.
+	bool Update(size_t slot, const std::shared_ptr<Mesh>& mesh);
+
+	// Forces the slot's cell to re-merge, e.g. after its vertices were edited.
+	void Invalidate(size_t slot);
+	void Remove(size_t slot);
+	void Clear();
+
+	bool IsBatched(size_t slot) const { return slot < slots.size() && slots[slot].batch >= 0; }
+
+	// Re-merges the cells touched since the last call; returns how many.
+	size_t Rebuild();
+
+	const std::vector<Batch>& Batches() const { return batches; }
+
+private:
+	struct SlotState {
+		std::shared_ptr<const MeshGeometry> geometry;
+		std::shared_ptr<Texture>            texture;
+		Transform transform;
+		int       batch = -1;
+	};
+
+	struct BatchKey {
+		uint64_t       cell;      // packed
+		const Texture* texture;
+		bool operator==(const BatchKey& other) const { return cell == other.cell && texture == other.texture; }
+	};
+	struct BatchKeyHash {
+		size_t operator()(const BatchKey& key) const;
+	};
+
+	float cellSize;
+	std::vector<SlotState> slots;
+	std::vector<Batch>     batches;
+	std::unordered_map<BatchKey, int, BatchKeyHash> cellBatches;   // -> index into batches
+
+	int  BatchFor(const glm::ivec3& cell, const std::shared_ptr<Texture>& texture);
+	void Detach(size_t slot);
+	void Merge(Batch& batch);
+};
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// How a TextureMip's bytes are laid out. The BC formats store 4x4 texel
+// blocks, a row of blocks at a time; edges that aren't a multiple of 4 are
+// padded out to a whole block.
+enum class PixelFormat : uint32_t {
+	RGBA8 = 0,   // 4 bytes per texel, red first
+	BC1   = 1,   // DXT1: opaque RGB, 8 bytes per block
+	BC3   = 2,   // DXT5: RGB plus smooth alpha, 16 bytes per block
+	BC5   = 3,   // RGTC2: two independent channels (normal map XY), 16 bytes per block
+};
+
+// On-disk layout of a cooked .gwtex file (little endian):
+//
+//   TextureFileHeader                   (48 bytes)
+//   TextureLevelEntry levels[levelCount] at levelOffset
+//   level data                          at each entry's offset
+//
+// Level data is exactly what the renderer uploads (RGBA8 rows or BC
+// blocks), on 16-byte boundaries, so loading is a map and one copy per
+// level with no decoding.
+namespace TextureFormat {
+	constexpr char     Magic[4]   = { 'G', 'W', 'T', 'X' };
+	constexpr uint32_t Version    = 1;
+	constexpr uint32_t Alignment  = 16;
+	constexpr const char* Extension = ".gwtex";
+
+	struct TextureFileHeader {
+		char     magic[4];
+		uint32_t version;
+		uint32_t format;         // PixelFormat
+		uint32_t width;          // level 0
+		uint32_t height;
+		uint32_t levelCount;
+		uint32_t levelOffset;    // byte offset of the level table
+		uint32_t reserved0;
+		uint64_t sourceSize;     // size of the image this was cooked from
+		uint32_t reserved[2];
+	};
+	static_assert(sizeof(TextureFileHeader) == 48, "TextureFileHeader layout changed");
+
+	struct TextureLevelEntry {
+		uint32_t offset;
+		uint32_t size;
+		uint32_t width;
+		uint32_t height;
+	};
+	static_assert(sizeof(TextureLevelEntry) == 16, "TextureLevelEntry layout changed");
+
+	inline uint64_t AlignUp(uint64_t value) {
+		return (value + Alignment - 1) & ~uint64_t(Alignment - 1);
+	}
+}
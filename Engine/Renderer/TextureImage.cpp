@@ -0,0 +1,310 @@
+#include "TextureImage.h"
+#include "BlockCompression.h"
+#include "../Core/MappedFile.h"
+#include "../Core/Logger.h"
+#include "../Core/stb_impl.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+namespace {
+	bool IsBlockFormat(PixelFormat format) {
+		return format == PixelFormat::BC1 || format == PixelFormat::BC3 || format == PixelFormat::BC5;
+	}
+
+	size_t BlockBytes(PixelFormat format) {
+		return format == PixelFormat::BC1 ? 8 : 16;
+	}
+}
+
+size_t TextureImage::ByteSize() const {
+	size_t bytes = 0;
+	for (const TextureMip& mip : mips) {
+		bytes += mip.data.size();
+	}
+	return bytes;
+}
+
+bool TextureImage::LoadFromFile(const std::string& path) {
+	int width, height, channels;
+	unsigned char* data = stb_impl::LoadImageFromFile(path.c_str(), &width, &height, &channels, 4);
+	if (!data) {
+		return false;
+	}
+	format = PixelFormat::RGBA8;
+	mips.assign(1, TextureMip());
+	mips[0].width  = width;
+	mips[0].height = height;
+	mips[0].data.assign(data, data + size_t(width) * height * 4);
+	stb_impl::FreeImageData(data);
+	return true;
+}
+
+int TextureImage::MipCountFor(int width, int height) {
+	int count = 1;
+	while (width > 1 || height > 1) {
+		width  = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+		count++;
+	}
+	return count;
+}
+
+void TextureImage::GenerateMips() {
+	if (mips.empty() || IsCompressed()) {
+		return;
+	}
+	mips.resize(MipCountFor(mips[0].width, mips[0].height));
+	for (size_t level = 1; level < mips.size(); ++level) {
+		const TextureMip& src = mips[level - 1];
+		TextureMip&       dst = mips[level];
+		dst.width  = std::max(1, src.width / 2);
+		dst.height = std::max(1, src.height / 2);
+		dst.data.resize(size_t(dst.width) * dst.height * 4);
+
+		// each destination pixel averages the source pixels of its box:
+		// 2x2 normally, 3 wide or tall where an odd source edge is folded in
+		for (int y = 0; y < dst.height; ++y) {
+			int y0 = std::min(y * 2, src.height - 1);
+			int y1 = (y == dst.height - 1) ? src.height : std::min(y * 2 + 2, src.height);
+			for (int x = 0; x < dst.width; ++x) {
+				int x0 = std::min(x * 2, src.width - 1);
+				int x1 = (x == dst.width - 1) ? src.width : std::min(x * 2 + 2, src.width);
+				uint32_t sum[4] = {};
+				for (int sy = y0; sy < y1; ++sy) {
+					const uint8_t* row = src.data.data() + (size_t(sy) * src.width + x0) * 4;
+					for (int sx = x0; sx < x1; ++sx, row += 4) {
+						sum[0] += row[0];
+						sum[1] += row[1];
+						sum[2] += row[2];
+						sum[3] += row[3];
+					}
+				}
+				uint32_t count = uint32_t((y1 - y0) * (x1 - x0));
+				uint8_t* out = dst.data.data() + (size_t(y) * dst.width + x) * 4;
+				for (int c = 0; c < 4; ++c) {
+					out[c] = uint8_t((sum[c] + count / 2) / count);
+				}
+			}
+		}
+	}
+}
+
+size_t TextureImage::LevelSize(PixelFormat format, int width, int height) {
+	if (!IsBlockFormat(format)) {
+		return size_t(width) * height * 4;
+	}
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(format);
+}
+
+bool TextureImage::Compress(PixelFormat target) {
+	if (IsCompressed()) {
+		return false;
+	}
+	if (!IsBlockFormat(target)) {
+		return true;
+	}
+	for (TextureMip& mip : mips) {
+		int blocksWide = (mip.width + 3) / 4;
+		int blocksHigh = (mip.height + 3) / 4;
+		std::vector<uint8_t> blocks(LevelSize(target, mip.width, mip.height));
+		uint8_t* out = blocks.data();
+		uint8_t  texels[64];
+		for (int by = 0; by < blocksHigh; ++by) {
+			for (int bx = 0; bx < blocksWide; ++bx, out += BlockBytes(target)) {
+				for (int y = 0; y < 4; ++y) {
+					int sy = std::min(by * 4 + y, mip.height - 1);
+					for (int x = 0; x < 4; ++x) {
+						int sx = std::min(bx * 4 + x, mip.width - 1);
+						memcpy(texels + (y * 4 + x) * 4, mip.data.data() + (size_t(sy) * mip.width + sx) * 4, 4);
+					}
+				}
+				switch (target) {
+				case PixelFormat::BC1: BlockCompression::EncodeBC1(texels, out); break;
+				case PixelFormat::BC3: BlockCompression::EncodeBC3(texels, out); break;
+				default:               BlockCompression::EncodeBC5(texels, out); break;
+				}
+			}
+		}
+		mip.data.swap(blocks);
+	}
+	format = target;
+	return true;
+}
+
+void TextureImage::Decompress() {
+	if (!IsCompressed()) {
+		return;
+	}
+	for (TextureMip& mip : mips) {
+		int blocksWide = (mip.width + 3) / 4;
+		int blocksHigh = (mip.height + 3) / 4;
+		std::vector<uint8_t> pixels(size_t(mip.width) * mip.height * 4);
+		const uint8_t* in = mip.data.data();
+		uint8_t texels[64];
+		for (int by = 0; by < blocksHigh; ++by) {
+			for (int bx = 0; bx < blocksWide; ++bx, in += BlockBytes(format)) {
+				switch (format) {
+				case PixelFormat::BC1: BlockCompression::DecodeBC1(in, texels); break;
+				case PixelFormat::BC3: BlockCompression::DecodeBC3(in, texels); break;
+				default:               BlockCompression::DecodeBC5(in, texels); break;
+				}
+				// the padding outside the image is dropped
+				for (int y = 0; y < 4 && by * 4 + y < mip.height; ++y) {
+					for (int x = 0; x < 4 && bx * 4 + x < mip.width; ++x) {
+						memcpy(pixels.data() + (size_t(by * 4 + y) * mip.width + bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+					}
+				}
+			}
+		}
+		mip.data.swap(pixels);
+	}
+	format = PixelFormat::RGBA8;
+}
+
+std::string TextureImage::CookedPathFor(const std::string& sourcePath) {
+	return std::filesystem::path(sourcePath).replace_extension(TextureFormat::Extension).string();
+}
+
+bool TextureImage::Load(const std::string& path) {
+	namespace fs = std::filesystem;
+
+	if (fs::path(path).extension() == TextureFormat::Extension) {
+		return LoadFromCooked(path);
+	}
+
+	// a stale cook (source edited after cooking) falls through to the source
+	std::error_code ec;
+	std::string cooked = CookedPathFor(path);
+	auto cookedTime = fs::last_write_time(cooked, ec);
+	if (!ec) {
+		auto sourceTime = fs::last_write_time(path, ec);
+		if ((ec || cookedTime >= sourceTime) && LoadFromCooked(cooked)) {
+			return true;
+		}
+	}
+
+	return LoadFromFile(path);
+}
+
+bool TextureImage::LoadFromCooked(const std::string& path) {
+	using TextureFormat::TextureFileHeader;
+	using TextureFormat::TextureLevelEntry;
+
+	MappedFile file;
+	if (!file.Open(path)) {
+		Logger::Error("Failed to open cooked texture: " + path);
+		return false;
+	}
+	if (file.Size() < sizeof(TextureFileHeader)) {
+		Logger::Error("Cooked texture is truncated: " + path);
+		return false;
+	}
+
+	TextureFileHeader header;
+	memcpy(&header, file.Data(), sizeof(header));
+	if (memcmp(header.magic, TextureFormat::Magic, 4) != 0
+		|| header.version != TextureFormat::Version
+		|| header.format > uint32_t(PixelFormat::BC5)) {
+		Logger::Warn("Cooked texture has an old or foreign format, ignoring: " + path);
+		return false;
+	}
+
+	uint64_t tableBytes = uint64_t(header.levelCount) * sizeof(TextureLevelEntry);
+	if (header.levelCount == 0 || header.levelCount > 32 || header.levelOffset + tableBytes > file.Size()) {
+		Logger::Error("Cooked texture level table is out of range: " + path);
+		return false;
+	}
+	std::vector<TextureLevelEntry> table(header.levelCount);
+	memcpy(table.data(), file.Data() + header.levelOffset, tableBytes);
+
+	// the levels must form the chain the header describes, since renderers
+	// size every level of the GPU texture from level 0
+	PixelFormat fileFormat = PixelFormat(header.format);
+	for (size_t i = 0; i < table.size(); ++i) {
+		const TextureLevelEntry& entry = table[i];
+		if (header.width == 0 || header.height == 0
+			|| entry.width != std::max(1u, header.width >> i)
+			|| entry.height != std::max(1u, header.height >> i)
+			|| entry.size != LevelSize(fileFormat, int(entry.width), int(entry.height))
+			|| entry.offset + uint64_t(entry.size) > file.Size()) {
+			Logger::Error("Cooked texture level is out of range: " + path);
+			return false;
+		}
+	}
+
+	format = fileFormat;
+	mips.resize(table.size());
+	for (size_t i = 0; i < table.size(); ++i) {
+		mips[i].width  = int(table[i].width);
+		mips[i].height = int(table[i].height);
+		mips[i].data.assign(file.Data() + table[i].offset, file.Data() + table[i].offset + table[i].size);
+	}
+	return true;
+}
+
+bool TextureImage::SaveCooked(const std::string& path, uint64_t sourceSize) const {
+	using TextureFormat::TextureFileHeader;
+	using TextureFormat::TextureLevelEntry;
+
+	if (mips.empty()) {
+		return false;
+	}
+
+	TextureFileHeader header{};
+	memcpy(header.magic, TextureFormat::Magic, 4);
+	header.version     = TextureFormat::Version;
+	header.format      = uint32_t(format);
+	header.width       = uint32_t(Width());
+	header.height      = uint32_t(Height());
+	header.levelCount  = uint32_t(mips.size());
+	header.levelOffset = uint32_t(TextureFormat::AlignUp(sizeof(TextureFileHeader)));
+	header.sourceSize  = sourceSize;
+
+	std::vector<TextureLevelEntry> table(mips.size());
+	uint64_t offset = TextureFormat::AlignUp(header.levelOffset + table.size() * sizeof(TextureLevelEntry));
+	for (size_t i = 0; i < mips.size(); ++i) {
+		table[i].offset = uint32_t(offset);
+		table[i].size   = uint32_t(mips[i].data.size());
+		table[i].width  = uint32_t(mips[i].width);
+		table[i].height = uint32_t(mips[i].height);
+		offset = TextureFormat::AlignUp(offset + mips[i].data.size());
+	}
+
+	// write next to the target and rename, so a crashed cook never leaves a
+	// half-written file that looks newer than its source
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			Logger::Error("Failed to write cooked texture: " + path);
+			return false;
+		}
+
+		const char padding[TextureFormat::Alignment] = {};
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(padding, header.levelOffset - sizeof(header));
+		out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(TextureLevelEntry));
+		uint64_t written = header.levelOffset + table.size() * sizeof(TextureLevelEntry);
+		for (size_t i = 0; i < mips.size(); ++i) {
+			out.write(padding, table[i].offset - written);
+			out.write(reinterpret_cast<const char*>(mips[i].data.data()), mips[i].data.size());
+			written = table[i].offset + mips[i].data.size();
+		}
+
+		if (!out) {
+			Logger::Error("Failed to write cooked texture: " + path);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, path, ec);
+	if (ec) {
+		Logger::Error("Failed to replace cooked texture " + path + ": " + ec.message());
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,55 @@
+// TextureImage.h
+#pragma once
+
+#include "TextureFormat.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// One level of a mip chain: tightly packed RGBA8 rows or BC blocks, top
+// row first, depending on the image's format.
+struct TextureMip {
+	int                  width  = 0;
+	int                  height = 0;
+	std::vector<uint8_t> data;
+};
+
+// A texture on the CPU: level 0 is the image itself, each further level
+// half the size of the one before (rounded down, at least 1) down to 1x1.
+// Nothing here touches a graphics API, so it can be built on any thread
+// and handed to whichever renderer uploads it.
+class TextureImage {
+public:
+	PixelFormat             format = PixelFormat::RGBA8;
+	std::vector<TextureMip> mips;
+
+	int Width() const  { return mips.empty() ? 0 : mips[0].width; }
+	int Height() const { return mips.empty() ? 0 : mips[0].height; }
+	bool IsCompressed() const { return format != PixelFormat::RGBA8; }
+	size_t ByteSize() const;
+
+	// Loads `path`, preferring its cooked .gwtex sibling when that is newer.
+	bool Load(const std::string& path);
+	// Decodes `path` (anything stb_image reads) into level 0 as RGBA8.
+	bool LoadFromFile(const std::string& path);
+	bool LoadFromCooked(const std::string& path);
+	bool SaveCooked(const std::string& path, uint64_t sourceSize = 0) const;
+
+	// Rebuilds levels 1.. from level 0 with a 2x2 box filter; an odd row
+	// or column is folded into its neighbour's box. RGBA8 only.
+	void GenerateMips();
+
+	// Encodes every level into `target`, edges padded by repeating the last
+	// row and column. Fails on an already compressed image.
+	bool Compress(PixelFormat target);
+	// Back to RGBA8, for renderers that can't sample the compressed format.
+	void Decompress();
+
+	// Number of levels a full chain for a `width` x `height` image has.
+	static int MipCountFor(int width, int height);
+	// Bytes one level takes in `format`.
+	static size_t LevelSize(PixelFormat format, int width, int height);
+	// "assets/textures/stone.png" -> "assets/textures/stone.gwtex"
+	static std::string CookedPathFor(const std::string& sourcePath);
+};
@@ -0,0 +1,182 @@
+#include "TextureManager.h"
+#include "IRenderer.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Logger.h"
+
+std::mutex                                               TextureManager::mutex;
+std::unordered_map<std::string, std::weak_ptr<Texture>> TextureManager::textures;
+std::deque<TextureManager::Upload>                       TextureManager::uploads;
+std::vector<uintptr_t>                                   TextureManager::retired;
+uint32_t                                                 TextureManager::nextId = 0;
+
+std::shared_ptr<Texture> TextureManager::Load(const std::string& path) {
+	std::shared_ptr<Texture> texture;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = textures.find(path);
+		if (found != textures.end()) {
+			texture = found->second.lock();
+			if (texture) {
+				return texture;
+			}
+		}
+		texture = std::shared_ptr<Texture>(new Texture(path, ++nextId), Retire);
+		textures[path] = texture;
+	}
+
+	// the job only keeps a weak reference: a texture dropped before it is
+	// decoded isn't decoded at all
+	std::weak_ptr<Texture> weak = texture;
+	Core::JobSystem::Submit([weak, path]() { Decode(weak, path); });
+	return texture;
+}
+
+void TextureManager::Decode(std::weak_ptr<Texture> weak, std::string path) {
+	if (weak.expired()) {
+		return;
+	}
+	// a cooked .gwtex brings its own mips, usually block compressed
+	auto image = std::make_unique<TextureImage>();
+	bool loaded = image->Load(path);
+	if (loaded && image->mips.size() == 1 && !image->IsCompressed()) {
+		image->GenerateMips();
+	}
+
+	std::shared_ptr<Texture> texture = weak.lock();
+	if (!texture) {
+		return;
+	}
+	if (!loaded) {
+		Logger::Error("Failed to load texture: " + path);
+		texture->state.store(Texture::State::Failed, std::memory_order_release);
+		return;
+	}
+	texture->width  = image->Width();
+	texture->height = image->Height();
+	texture->state.store(Texture::State::Uploading, std::memory_order_release);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	uploads.push_back(Upload{ weak, std::move(image) });
+}
+
+void TextureManager::Retire(Texture* texture) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (texture->handle) {
+			retired.push_back(texture->handle);
+		}
+		// a new texture may already sit under the same path
+		auto found = textures.find(texture->path);
+		if (found != textures.end() && found->second.expired()) {
+			textures.erase(found);
+		}
+	}
+	delete texture;
+}
+
+size_t TextureManager::ProcessUploads(Renderer::IRenderer& renderer, size_t budgetBytes) {
+	std::vector<uintptr_t> dead;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dead.swap(retired);
+	}
+	for (uintptr_t handle : dead) {
+		renderer.DeleteTexture(handle);
+	}
+
+	size_t sent = 0;
+	while (sent == 0 || sent < budgetBytes) {
+		Upload upload;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (uploads.empty()) {
+				break;
+			}
+			upload = std::move(uploads.front());
+			uploads.pop_front();
+		}
+		std::shared_ptr<Texture> texture = upload.texture.lock();
+		if (!texture) {
+			continue;   // dropped while it waited
+		}
+
+		TextureImage& image = *upload.image;
+		int levels = int(image.mips.size());
+		if (!texture->handle) {
+			texture->handle = renderer.CreateTexture(image.Width(), image.Height(), levels, image.format);
+			if (!texture->handle && image.IsCompressed()) {
+				Logger::Warn("Renderer can't sample this texture's block format, decompressing: " + texture->path);
+				image.Decompress();
+				texture->handle = renderer.CreateTexture(image.Width(), image.Height(), levels, image.format);
+			}
+			if (!texture->handle) {
+				Logger::Error("Renderer could not create texture: " + texture->path);
+				texture->state.store(Texture::State::Failed, std::memory_order_release);
+				continue;
+			}
+		}
+
+		// level by level, so one big texture spreads over several frames
+		bool failed = false;
+		while (texture->levelsUploaded < levels && (sent == 0 || sent < budgetBytes)) {
+			const TextureMip& mip = image.mips[texture->levelsUploaded];
+			if (!renderer.UploadTextureLevel(texture->handle, texture->levelsUploaded, mip.width, mip.height, mip.data.data(), mip.data.size())) {
+				failed = true;
+				break;
+			}
+			texture->levelsUploaded++;
+			sent += mip.data.size();
+		}
+
+		if (failed) {
+			Logger::Error("Texture upload failed: " + texture->path);
+			texture->state.store(Texture::State::Failed, std::memory_order_release);
+		} else if (texture->levelsUploaded == levels) {
+			texture->state.store(Texture::State::Ready, std::memory_order_release);
+		} else {
+			// out of budget halfway; the rest goes first next frame
+			std::lock_guard<std::mutex> lock(mutex);
+			uploads.push_front(std::move(upload));
+		}
+	}
+	return sent;
+}
+
+void TextureManager::ReleaseAll(Renderer::IRenderer& renderer) {
+	std::vector<std::shared_ptr<Texture>> live;
+	std::vector<uintptr_t>                dead;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dead.swap(retired);
+		uploads.clear();
+		for (auto& entry : textures) {
+			if (auto texture = entry.second.lock()) {
+				live.push_back(texture);
+			}
+		}
+		textures.clear();
+	}
+	for (uintptr_t handle : dead) {
+		renderer.DeleteTexture(handle);
+	}
+	for (auto& texture : live) {
+		if (texture->handle) {
+			renderer.DeleteTexture(texture->handle);
+			texture->handle = 0;
+		}
+		texture->levelsUploaded = 0;
+		if (texture->GetState() != Texture::State::Failed) {
+			texture->state.store(Texture::State::Loading, std::memory_order_release);
+		}
+	}
+}
+
+size_t TextureManager::PendingUploads() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return uploads.size();
+}
+
+size_t TextureManager::Size() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return textures.size();
+}
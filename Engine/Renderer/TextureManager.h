@@ -0,0 +1,91 @@
+// TextureManager.h
+#pragma once
+
+#include "TextureImage.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Renderer { class IRenderer; }
+
+// A texture as materials see it. Handles are shared and keyed by path;
+// the texture draws as soon as every level is on the GPU, until then
+// (or if loading failed) whatever uses it draws untextured.
+class Texture {
+public:
+	enum class State : uint8_t { Loading, Uploading, Ready, Failed };
+
+	const std::string& Path() const { return path; }
+	State GetState() const { return state.load(std::memory_order_acquire); }
+	bool  Ready() const    { return GetState() == State::Ready; }
+	int   Width() const    { return width; }
+	int   Height() const   { return height; }
+	// small and unique per texture, for sort keys; never 0
+	uint32_t Id() const    { return id; }
+
+	// The renderer's object (GL name, IDirect3DTexture9*); only meaningful
+	// on the thread that renders, once Ready.
+	uintptr_t Handle() const { return handle; }
+
+private:
+	friend class TextureManager;
+	explicit Texture(std::string path, uint32_t id) : path(std::move(path)), id(id) {}
+
+	std::string        path;
+	uint32_t           id;
+	std::atomic<State> state{State::Loading};
+	int                width  = 0;   // written before the state leaves Loading
+	int                height = 0;
+	uintptr_t          handle = 0;   // render thread
+	int                levelsUploaded = 0;
+};
+
+// Loads textures without stalling anyone. Images are read on the job
+// system, a cooked .gwtex as it is, anything else decoded with its mip
+// chain box-filtered there. The finished chains wait in an upload queue
+// that the renderer drains at the start of each frame, on its own thread,
+// up to a byte budget so a burst of loads is spread over several frames
+// instead of hitching one. Handles nobody holds any more are freed on the
+// GPU in the same pass.
+class TextureManager {
+public:
+	static constexpr size_t DefaultUploadBudget = 4u << 20;
+
+	// The texture for `path`, starting a background load if nobody holds
+	// it already. Never blocks; safe from any thread.
+	static std::shared_ptr<Texture> Load(const std::string& path);
+
+	// Renderer side, on the thread that renders: frees retired textures,
+	// then uploads queued levels until `budgetBytes` are spent (at least one
+	// level always goes, however large). Returns the bytes uploaded.
+	static size_t ProcessUploads(Renderer::IRenderer& renderer, size_t budgetBytes = DefaultUploadBudget);
+
+	// Frees every GPU texture through `renderer` before its device goes.
+	// Handles still held stay untextured; Load hands out new ones.
+	static void ReleaseAll(Renderer::IRenderer& renderer);
+
+	static size_t PendingUploads();
+	static size_t Size();
+
+private:
+	struct Upload {
+		std::weak_ptr<Texture>        texture;
+		std::unique_ptr<TextureImage> image;
+	};
+
+	static void Decode(std::weak_ptr<Texture> texture, std::string path);
+	// shared_ptr deleter: the GPU object can only go on the render thread
+	static void Retire(Texture* texture);
+
+	static std::mutex                                               mutex;
+	static std::unordered_map<std::string, std::weak_ptr<Texture>> textures;
+	static std::deque<Upload>                                       uploads;
+	static std::vector<uintptr_t>                                   retired;
+	static uint32_t                                                 nextId;
+};
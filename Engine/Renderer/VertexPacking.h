@@ -0,0 +1,132 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// Encode/decode helpers for PackedVertex (see Mesh.h).
+namespace VertexPacking {
+	constexpr float SnormMax16 = 32767.0f;
+	constexpr float SnormMax8  = 127.0f;
+
+	// IEEE half with round-to-nearest; out-of-range values become +-inf.
+	inline uint16_t FloatToHalf(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign     = (bits >> 16) & 0x8000u;
+		uint32_t rawExp   = (bits >> 23) & 0xFFu;
+		uint32_t mantissa = bits & 0x7FFFFFu;
+		int32_t  exponent = int32_t(rawExp) - 127 + 15;
+
+		if (rawExp == 0xFF) {
+			return uint16_t(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+		}
+		if (exponent >= 31) {
+			return uint16_t(sign | 0x7C00u);
+		}
+		if (exponent <= 0) {
+			if (exponent < -10) return uint16_t(sign);
+			mantissa |= 0x800000u;
+			uint32_t shift = uint32_t(14 - exponent);
+			uint32_t half  = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1u) ++half;
+			return uint16_t(sign | half);
+		}
+
+		uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+		if (mantissa & 0x1000u) ++half;   // a carry rolls into the exponent correctly
+		return uint16_t(half);
+	}
+
+	inline float HalfToFloat(uint16_t half) {
+		uint32_t sign     = uint32_t(half & 0x8000u) << 16;
+		uint32_t exponent = (half >> 10) & 0x1Fu;
+		uint32_t mantissa = half & 0x3FFu;
+		uint32_t bits;
+
+		if (exponent == 0) {
+			if (mantissa == 0) {
+				bits = sign;
+			} else {
+				// subnormal: renormalize
+				exponent = 127 - 15 + 1;
+				while (!(mantissa & 0x400u)) {
+					mantissa <<= 1;
+					--exponent;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+			}
+		} else if (exponent == 31) {
+			bits = sign | 0x7F800000u | (mantissa << 13);
+		} else {
+			bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// Octahedral normal encoding (Meyer et al. 2010): project onto the
+	// octahedron, fold the lower half over, store the two coordinates.
+	inline void OctEncode(const glm::vec3& n, int8_t out[2]) {
+		float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+		if (l1 <= 0.0f) {
+			out[0] = out[1] = 0;
+			return;
+		}
+		float x = n.x / l1, y = n.y / l1;
+		if (n.z < 0.0f) {
+			float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = fx;
+			y = fy;
+		}
+		out[0] = int8_t(std::lround(std::clamp(x, -1.0f, 1.0f) * SnormMax8));
+		out[1] = int8_t(std::lround(std::clamp(y, -1.0f, 1.0f) * SnormMax8));
+	}
+
+	inline glm::vec3 OctDecode(const int8_t in[2]) {
+		float x = std::max(in[0] / SnormMax8, -1.0f);
+		float y = std::max(in[1] / SnormMax8, -1.0f);
+		glm::vec3 n(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+		float t = std::max(-n.z, 0.0f);
+		n.x += n.x >= 0.0f ? -t : t;
+		n.y += n.y >= 0.0f ? -t : t;
+		return glm::normalize(n);
+	}
+
+	// Positions are stored as snorm16 of (p - offset) / halfExtent, so decoding
+	// is offset + q * scale with scale = halfExtent / 32767.
+	struct Quantization {
+		glm::vec3 offset = glm::vec3(0.0f);
+		glm::vec3 scale  = glm::vec3(1.0f);
+	};
+
+	inline Quantization QuantizationFor(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+		Quantization q;
+		q.offset = (boundsMin + boundsMax) * 0.5f;
+		glm::vec3 half = (boundsMax - boundsMin) * 0.5f;
+		for (int i = 0; i < 3; ++i) {
+			// flat axes still need a non-zero scale for the model matrix
+			q.scale[i] = (half[i] > 0.0f ? half[i] : 1.0f) / SnormMax16;
+		}
+		return q;
+	}
+
+	inline void QuantizePosition(const glm::vec3& p, const Quantization& q, int16_t out[3]) {
+		for (int i = 0; i < 3; ++i) {
+			float v = (p[i] - q.offset[i]) / q.scale[i];
+			out[i] = int16_t(std::lround(std::clamp(v, -SnormMax16, SnormMax16)));
+		}
+	}
+
+	inline glm::vec3 DequantizePosition(const int16_t in[3], const Quantization& q) {
+		return glm::vec3(q.offset.x + in[0] * q.scale.x,
+						 q.offset.y + in[1] * q.scale.y,
+						 q.offset.z + in[2] * q.scale.z);
+	}
+}
@@ -0,0 +1,193 @@
+// Cook.cpp
+// Offline asset cooker: converts OBJ sources into .gwmesh files that the
+// engine maps straight into MeshGeometry at startup (see Renderer/MeshFormat.h),
+// and images into block-compressed .gwtex files (see Renderer/TextureFormat.h).
+//
+//   gwcook [--force] [--no-optimize] [--no-lods] [--pack]
+//          [--format auto|bc1|bc3|bc5|rgba8] [--no-mips] [path ...]
+//
+// Each path may be an .obj or image file or a directory that is scanned for
+// them. Defaults to assets/models and assets/textures, so run it from the
+// repo root. Sources whose cooked file is already newer are skipped unless
+// --force is given.
+// Meshes get a LOD chain (MeshSimplifier) and are run through MeshOptimizer
+// unless --no-lods / --no-optimize is given; the cooked header records what
+// was done so the engine does not repeat it at load time. --pack stores
+// 12-byte PackedVertex data instead of full float vertices.
+// Images get a box-filtered mip chain unless --no-mips is given and are
+// encoded to --format; auto picks BC1 for opaque images and BC3 otherwise.
+// BC5 is for normal maps (red and green only). Images whose size isn't a
+// multiple of 4 stay RGBA8, since D3D9 can't create them compressed.
+#include "Renderer/Mesh.h"
+#include "Renderer/TextureImage.h"
+#include "Core/Logger.h"
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static bool IsUpToDate(const fs::path& source, const fs::path& cooked) {
+	std::error_code ec;
+	auto cookedTime = fs::last_write_time(cooked, ec);
+	if (ec) return false;
+	auto sourceTime = fs::last_write_time(source, ec);
+	return !ec && cookedTime >= sourceTime;
+}
+
+static bool IsImage(const fs::path& path) {
+	std::string ext = path.extension().string();
+	for (char& c : ext) c = char(tolower(c));
+	return ext == ".png" || ext == ".bmp" || ext == ".tga" || ext == ".jpg" || ext == ".jpeg";
+}
+
+static void CollectSources(const fs::path& path, std::vector<fs::path>& out) {
+	std::error_code ec;
+	if (fs::is_directory(path, ec)) {
+		for (const auto& entry : fs::directory_iterator(path, ec)) {
+			if (entry.is_regular_file() && (entry.path().extension() == ".obj" || IsImage(entry.path()))) {
+				out.push_back(entry.path());
+			}
+		}
+	} else if (fs::is_regular_file(path, ec)) {
+		out.push_back(path);
+	} else {
+		Logger::Warn("Skipping missing path: " + path.string());
+	}
+}
+
+static const char* FormatName(PixelFormat format) {
+	switch (format) {
+	case PixelFormat::BC1: return "BC1";
+	case PixelFormat::BC3: return "BC3";
+	case PixelFormat::BC5: return "BC5";
+	default:               return "RGBA8";
+	}
+}
+
+// `automatic` picks BC1 or BC3 from the image's alpha
+static bool CookTexture(const fs::path& source, const fs::path& target, PixelFormat format, bool automatic,
+						bool mips, uint64_t sourceSize) {
+	TextureImage image;
+	if (!image.LoadFromFile(source.string())) {
+		return false;
+	}
+	if (automatic) {
+		const std::vector<uint8_t>& texels = image.mips[0].data;
+		format = PixelFormat::BC1;
+		for (size_t i = 3; i < texels.size(); i += 4) {
+			if (texels[i] != 255) {
+				format = PixelFormat::BC3;
+				break;
+			}
+		}
+	}
+	if (format != PixelFormat::RGBA8 && (image.Width() % 4 != 0 || image.Height() % 4 != 0)) {
+		Logger::Warn(source.string() + " is " + std::to_string(image.Width()) + "x" + std::to_string(image.Height())
+					 + ", not a multiple of 4; keeping it RGBA8");
+		format = PixelFormat::RGBA8;
+	}
+	if (mips) {
+		image.GenerateMips();
+	}
+	size_t rawBytes = image.ByteSize();
+	image.Compress(format);
+	if (!image.SaveCooked(target.string(), sourceSize)) {
+		return false;
+	}
+	Logger::Info(std::string(FormatName(format)) + ", " + std::to_string(image.mips.size()) + " levels, "
+				 + std::to_string(rawBytes) + " bytes as RGBA8 -> " + std::to_string(image.ByteSize()));
+	return true;
+}
+
+int main(int argc, char** argv) {
+	bool force = false;
+	uint32_t flags = MeshLoad_Optimize | MeshLoad_Lods;
+	PixelFormat textureFormat = PixelFormat::BC1;
+	bool autoFormat = true;
+	bool textureMips = true;
+	std::vector<fs::path> inputs;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--force" || arg == "-f") {
+			force = true;
+		} else if (arg == "--no-optimize") {
+			flags &= ~uint32_t(MeshLoad_Optimize);
+		} else if (arg == "--no-lods") {
+			flags &= ~uint32_t(MeshLoad_Lods);
+		} else if (arg == "--pack") {
+			flags |= MeshLoad_Pack;
+		} else if (arg == "--no-mips") {
+			textureMips = false;
+		} else if (arg == "--format" && i + 1 < argc) {
+			std::string name = argv[++i];
+			autoFormat = name == "auto";
+			if (name == "bc1") {
+				textureFormat = PixelFormat::BC1;
+			} else if (name == "bc3") {
+				textureFormat = PixelFormat::BC3;
+			} else if (name == "bc5") {
+				textureFormat = PixelFormat::BC5;
+			} else if (name == "rgba8") {
+				textureFormat = PixelFormat::RGBA8;
+			} else if (!autoFormat) {
+				Logger::Error("Unknown texture format: " + name);
+				return 1;
+			}
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+	if (inputs.empty()) {
+		inputs.push_back("assets/models");
+		inputs.push_back("assets/textures");
+	}
+
+	std::vector<fs::path> sources;
+	for (const auto& input : inputs) {
+		CollectSources(input, sources);
+	}
+
+	int cooked = 0, skipped = 0, failed = 0;
+	for (const auto& source : sources) {
+		bool texture = IsImage(source);
+		fs::path target = texture ? TextureImage::CookedPathFor(source.string()) : MeshGeometry::CookedPathFor(source.string());
+
+		if (!force && IsUpToDate(source, target)) {
+			++skipped;
+			continue;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::error_code ec;
+		uint64_t sourceSize = fs::file_size(source, ec);
+		bool ok;
+		if (texture) {
+			ok = CookTexture(source, target, textureFormat, autoFormat, textureMips, ec ? 0 : sourceSize);
+		} else {
+			MeshGeometry mesh;
+			ok = mesh.LoadFromOBJ(source.string(), flags) && mesh.SaveCooked(target.string(), ec ? 0 : sourceSize);
+		}
+		if (!ok) {
+			Logger::Error("Failed to cook " + source.string());
+			++failed;
+			continue;
+		}
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		uint64_t cookedSize = fs::file_size(target, ec);
+		Logger::Info("Cooked " + source.string() + " -> " + target.string()
+					 + " (" + std::to_string(sourceSize) + " -> " + std::to_string(cookedSize)
+					 + " bytes, " + std::to_string(ms) + " ms)");
+		++cooked;
+	}
+
+	Logger::Info(std::to_string(cooked) + " cooked, " + std::to_string(skipped)
+				 + " up to date, " + std::to_string(failed) + " failed");
+	return failed == 0 ? 0 : 1;
+}
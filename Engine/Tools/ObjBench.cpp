@@ -0,0 +1,199 @@
+// ObjBench.cpp
+// Throughput benchmarks for the OBJ loader:
+//  * the mapped ObjParser path in MeshGeometry::LoadFromOBJ against the original
+//    istringstream loader it replaced
+//  * ObjParser::Parse scaling across 1..N threads on an in-memory buffer made
+//    of `replicate` copies of the file, checked against the 1-thread output
+//
+//   gwobjbench [iterations] [--threads N] [--replicate K] [file.obj ...]
+//
+// Run from the repo root so the default asset paths resolve.
+#include "Renderer/Mesh.h"
+#include "Renderer/ObjParser.h"
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// The loader as it was before ObjParser, kept verbatim as the baseline.
+static bool LegacyLoadFromOBJ(const std::string& path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::vector<glm::vec3> tempPositions;
+	std::vector<glm::vec2> tempTexCoords;
+	std::vector<glm::vec3> tempNormals;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream iss(line);
+		std::string type;
+		iss >> type;
+		if (type == "v") {
+			glm::vec3 pos; iss >> pos.x >> pos.y >> pos.z;
+			tempPositions.push_back(pos);
+		}
+		else if (type == "vt") {
+			glm::vec2 uv; iss >> uv.x >> uv.y;
+			tempTexCoords.push_back(uv);
+		}
+		else if (type == "vn") {
+			glm::vec3 n; iss >> n.x >> n.y >> n.z;
+			tempNormals.push_back(n);
+		}
+		else if (type == "f") {
+			for (int i = 0; i < 3; ++i) {
+				std::string token; iss >> token;
+				std::replace(token.begin(), token.end(), '/', ' ');
+				std::istringstream tok(token);
+				int vi, ti, ni;
+				tok >> vi >> ti >> ni;
+
+				Vertex vert{};
+				vert.position = tempPositions[vi - 1];
+				vert.texcoord = tempTexCoords[ti - 1];
+				vert.normal   = tempNormals[ni - 1];
+
+				vertices.push_back(vert);
+				indices.push_back(static_cast<uint32_t>(indices.size()));
+			}
+		}
+	}
+	return true;
+}
+
+// The legacy loader is fully de-indexed, so expand the welded mesh through
+// its index buffer before comparing.
+static bool SameTriangles(const std::vector<Vertex>& legacy, const MeshGeometry& mesh) {
+	if (legacy.size() != mesh.indices.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < legacy.size(); ++i) {
+		if (memcmp(&legacy[i], &mesh.vertices[mesh.indices[i]], sizeof(Vertex)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+static bool SameArray(const std::vector<T>& a, const std::vector<T>& b) {
+	return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+static bool SameObj(const ObjParser::ObjData& a, const ObjParser::ObjData& b) {
+	return SameArray(a.positions, b.positions) && SameArray(a.texcoords, b.texcoords)
+		&& SameArray(a.normals, b.normals) && SameArray(a.corners, b.corners);
+}
+
+// Face indices are absolute, so concatenated copies of a file stay valid:
+// every copy's faces point at the first copy's vertices.
+static void ThreadScaling(const std::string& path, int iterations, unsigned maxThreads, int replicate) {
+	std::ifstream file(path, std::ios::binary);
+	std::string single((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (!single.empty() && single.back() != '\n') single.push_back('\n');
+
+	std::string text;
+	text.reserve(single.size() * replicate);
+	for (int i = 0; i < replicate; ++i) text += single;
+	double megabytes = double(text.size()) / (1024.0 * 1024.0);
+
+	std::cout << "  thread scaling on " << megabytes << " MB (" << replicate << " copies)\n";
+
+	ObjParser::ObjData reference;
+	double baseSec = 0.0;
+	for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+		ObjParser::ObjData data;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			ObjParser::Parse(text.data(), text.data() + text.size(), data, threads);
+		}
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		bool match = true;
+		if (threads == 1) {
+			reference = std::move(data);
+			baseSec = sec;
+		} else {
+			match = SameObj(reference, data);
+		}
+		std::cout << "    " << threads << " thread(s) : " << (megabytes * iterations / sec) << " MB/s, "
+				  << (baseSec / sec) << "x" << (match ? "" : "  OUTPUT DIFFERS") << "\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	int iterations = 20;
+	unsigned maxThreads = (std::max)(1u, std::thread::hardware_concurrency());
+	int replicate = 64;
+	std::vector<std::string> paths;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) {
+			maxThreads = (std::max)(1, std::stoi(argv[++i]));
+		} else if (arg == "--replicate" && i + 1 < argc) {
+			replicate = (std::max)(1, std::stoi(argv[++i]));
+		} else if (!arg.empty() && std::all_of(arg.begin(), arg.end(), ::isdigit)) {
+			iterations = (std::max)(1, std::stoi(arg));
+		} else {
+			paths.push_back(arg);
+		}
+	}
+	if (paths.empty()) {
+		paths = { "assets/models/test.obj", "assets/models/test2.obj", "assets/models/grid.obj" };
+	}
+
+	using Clock = std::chrono::steady_clock;
+
+	for (const auto& path : paths) {
+		std::ifstream probe(path, std::ios::binary | std::ios::ate);
+		if (!probe) {
+			std::cerr << "Cannot open " << path << "\n";
+			continue;
+		}
+		double megabytes = double(probe.tellg()) / (1024.0 * 1024.0);
+
+		std::vector<Vertex>   legacyVerts;
+		std::vector<uint32_t> legacyInds;
+		auto t0 = Clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			legacyVerts.clear();
+			legacyInds.clear();
+			LegacyLoadFromOBJ(path, legacyVerts, legacyInds);
+		}
+		double legacySec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+		// MeshGeometry::LoadFromOBJ logs every load, keep that out of the timing
+		std::ostringstream sink;
+		std::streambuf* coutBuf = std::cout.rdbuf(sink.rdbuf());
+		MeshGeometry mesh;
+		t0 = Clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			mesh.LoadFromOBJ(path);
+		}
+		double newSec = std::chrono::duration<double>(Clock::now() - t0).count();
+		std::cout.rdbuf(coutBuf);
+
+		bool match = SameTriangles(legacyVerts, mesh);
+		double weldRatio = mesh.vertices.empty() ? 1.0 : double(mesh.indices.size()) / double(mesh.vertices.size());
+
+		std::cout << path << " (" << megabytes << " MB, " << iterations << " iterations)\n"
+				  << "  legacy istringstream : " << (megabytes * iterations / legacySec) << " MB/s\n"
+				  << "  mapped from_chars    : " << (megabytes * iterations / newSec)    << " MB/s\n"
+				  << "  speedup              : " << (legacySec / newSec) << "x\n"
+				  << "  weld ratio           : " << weldRatio << ":1 ("
+				  << mesh.indices.size() << " corners -> " << mesh.vertices.size() << " verts)\n"
+				  << "  output matches       : " << (match ? "yes" : "NO") << "\n";
+
+		ThreadScaling(path, (std::max)(1, iterations / 4), maxThreads, replicate);
+	}
+	return 0;
+}